@@ -0,0 +1,188 @@
+#include "circuit.hpp"
+#include "circuit_pattern.hpp"
+#include "circuit_generators.hpp"
+#include "input_output.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+using Circuit::Generators::Edges;
+using Family = Edges(*)(unsigned number_of_nodes);
+
+// Families by approximate number of nodes
+Edges grid(unsigned number_of_nodes)
+{
+    const auto side = static_cast<unsigned>(std::sqrt(number_of_nodes));
+    return Circuit::Generators::grid(side, side);
+}
+
+Edges ladder(unsigned number_of_nodes)
+{
+    return Circuit::Generators::ladder(number_of_nodes / 2);
+}
+
+Edges random_sparse(unsigned number_of_nodes)
+{
+    return Circuit::Generators::random_sparse(number_of_nodes);
+}
+
+Edges many_components(unsigned number_of_nodes)
+{
+    return Circuit::Generators::many_components(number_of_nodes / 8, 8);
+}
+
+Edges giant_component(unsigned number_of_nodes)
+{
+    return Circuit::Generators::giant_component(number_of_nodes);
+}
+
+std::string to_text(const Edges& edges)
+{
+    std::ostringstream os {};
+    os.precision(17);
+    for (const auto& edge: edges)
+        os << edge.node1_ << " -- " << edge.node2_ << ", " << edge.resistance_ << "; " << edge.emf_ << "V\n";
+    return os.str();
+}
+
+void set_counters(benchmark::State& state, const Edges& edges)
+{
+    state.SetComplexityN(static_cast<std::int64_t>(edges.size()));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * edges.size()));
+    state.counters["edges"] = static_cast<double>(edges.size());
+}
+
+void construct_circuit(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    for (auto _: state)
+    {
+        Circuit::Circuit circuit (edges.cbegin(), edges.cend());
+        benchmark::DoNotOptimize(circuit);
+    }
+    set_counters(state, edges);
+}
+
+// Connected families only: dense slae is built for the whole circuit
+void make_slae(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    const Circuit::ConnectedCircuit circuit (edges.cbegin(), edges.cend());
+    for (auto _: state)
+    {
+        auto slae = circuit.make_slae();
+        benchmark::DoNotOptimize(slae);
+    }
+    set_counters(state, edges);
+}
+
+void solve_slae(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    const auto& slae = Circuit::ConnectedCircuit(edges.cbegin(), edges.cend()).make_slae();
+    for (auto _: state)
+    {
+        auto solution = slae.solve_slae();
+        benchmark::DoNotOptimize(solution);
+    }
+    set_counters(state, edges);
+}
+
+// Automatic choice of solvers, every iteration solves circuit from scratch
+void solve_circuit(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    const Circuit::Circuit circuit (edges.cbegin(), edges.cend());
+    for (auto _: state)
+    {
+        state.PauseTiming();
+        Circuit::Circuit copy = circuit;
+        state.ResumeTiming();
+        auto solution = copy.solve_circuit();
+        benchmark::DoNotOptimize(solution);
+    }
+    set_counters(state, edges);
+}
+
+// Every iteration solves batch_size value sets in one thread against pattern made once
+void solve_pattern(benchmark::State& state, Family family)
+{
+    constexpr std::size_t batch_size = 16;
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    Circuit::SolverOptions options {};
+    options.number_of_threads_ = 1;
+    const Circuit::CircuitPattern pattern (edges.cbegin(), edges.cend(), options);
+    Container::Vector<Circuit::CircuitPattern::ValueSet> value_sets {};
+    for (std::size_t i = 0; i < batch_size; ++i)
+        value_sets.push_back(pattern.values());
+    for (auto _: state)
+    {
+        auto currents = pattern.solve_batch(value_sets);
+        benchmark::DoNotOptimize(currents);
+    }
+    set_counters(state, edges);
+    state.counters["samples"] = benchmark::Counter(static_cast<double>(state.iterations() * batch_size),
+                                                   benchmark::Counter::kIsRate);
+}
+
+void input(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    const auto& text = to_text(edges);
+    for (auto _: state)
+    {
+        std::istringstream is {text};
+        auto input_edges = Circuit::InputOutput::input(is);
+        benchmark::DoNotOptimize(input_edges);
+    }
+    set_counters(state, edges);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+void output(benchmark::State& state, Family family)
+{
+    const auto& edges = family(static_cast<unsigned>(state.range(0)));
+    const auto& solution = Circuit::Circuit(edges.cbegin(), edges.cend()).solve_circuit();
+    std::ostringstream os {};
+    for (auto _: state)
+    {
+        os.str(std::string{});
+        Circuit::InputOutput::output(solution.cbegin(), solution.cend(), os);
+        benchmark::DoNotOptimize(os);
+    }
+    set_counters(state, edges);
+}
+
+constexpr std::int64_t min_nodes = 1 << 10, max_nodes = 1 << 16;
+// Dense slae of N + E rows takes (N + E)^2 memory and (N + E)^3 time
+constexpr std::int64_t min_dense_nodes = 1 << 4, max_dense_nodes = 1 << 8;
+} // namespace
+
+#define CIRCUIT_BENCHMARK(function, family, min, max) \
+    BENCHMARK_CAPTURE(function, family, family)->RangeMultiplier(4)->Range(min, max)->Complexity()->Unit(benchmark::kMicrosecond)
+
+#define CIRCUIT_BENCHMARK_ALL_FAMILIES(function, min, max) \
+    CIRCUIT_BENCHMARK(function, grid, min, max);            \
+    CIRCUIT_BENCHMARK(function, ladder, min, max);          \
+    CIRCUIT_BENCHMARK(function, random_sparse, min, max);   \
+    CIRCUIT_BENCHMARK(function, many_components, min, max); \
+    CIRCUIT_BENCHMARK(function, giant_component, min, max)
+
+#define CIRCUIT_BENCHMARK_CONNECTED_FAMILIES(function, min, max) \
+    CIRCUIT_BENCHMARK(function, grid, min, max);                  \
+    CIRCUIT_BENCHMARK(function, ladder, min, max);                \
+    CIRCUIT_BENCHMARK(function, giant_component, min, max)
+
+CIRCUIT_BENCHMARK_ALL_FAMILIES(construct_circuit, min_nodes, max_nodes);
+CIRCUIT_BENCHMARK_CONNECTED_FAMILIES(make_slae, min_dense_nodes, max_dense_nodes);
+CIRCUIT_BENCHMARK_CONNECTED_FAMILIES(solve_slae, min_dense_nodes, max_dense_nodes);
+CIRCUIT_BENCHMARK_ALL_FAMILIES(solve_circuit, min_nodes, max_nodes);
+CIRCUIT_BENCHMARK_ALL_FAMILIES(solve_pattern, min_nodes, max_nodes);
+CIRCUIT_BENCHMARK_ALL_FAMILIES(input, min_nodes, max_nodes);
+CIRCUIT_BENCHMARK_ALL_FAMILIES(output, min_nodes, max_nodes);
+
+BENCHMARK_MAIN();
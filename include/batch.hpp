@@ -0,0 +1,36 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "circuit.hpp"
+
+namespace Circuit
+{
+namespace Batch
+{
+// Returns text of the next circuit, std::nullopt at the end of batch. If it throws, the circuit is reported
+// as failed and the next one is read, so reader must move past the circuit it failed on.
+using Reader = std::function<std::optional<std::string>()>;
+
+// Every circuit passes pipeline of stages working in their own threads and connected by bounded queues:
+// reading, parsing, splitting in connected circuits, solving and formatting. Solving works in
+// options.number_of_threads_ threads (0 means std::thread::hardware_concurrency()) with one-thread schur solver,
+// solved circuits are put back in input order before formatting. Solutions are written in os
+// in input order and separated by empty lines, logs of solvers are written in options.log_ in the same order. If circuit fails, error is written in err with number of circuit
+// (from 1) and its solution is left empty.
+// Returns number of failed circuits
+std::size_t run(const Reader& reader, std::ostream& os, const SolverOptions& options = {}, std::ostream& err = std::cerr);
+
+// Circuits in is are separated by one or more empty lines
+std::size_t run(std::istream& is, std::ostream& os, const SolverOptions& options = {}, std::ostream& err = std::cerr);
+
+// Every regular file in directory is one circuit, files are taken in order of their names.
+// Throws std::filesystem::filesystem_error if directory can't be listed
+std::size_t run(const std::filesystem::path& directory, std::ostream& os, const SolverOptions& options = {},
+                std::ostream& err = std::cerr);
+} // namespace Batch
+} // namespace Circuit
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <queue>
+
+namespace Circuit
+{
+// Queue between pipeline stages: push() blocks while queue is full, pop() blocks while it is empty.
+// try_push() never blocks.
+// After close() push() and try_push() do nothing, pop() returns the rest of elements and then std::nullopt.
+template<typename T>
+class BoundedQueue final
+{
+    std::queue<T> queue_ = {};
+    std::size_t capacity_ = 0;
+    bool closed_ = false;
+
+    std::mutex mutex_ = {};
+    std::condition_variable not_full_  = {};
+    std::condition_variable not_empty_ = {};
+
+public:
+    explicit BoundedQueue(std::size_t capacity): capacity_ {capacity} {}
+
+    // false if queue is closed (before or while waiting)
+    bool push(T value)
+    {
+        std::unique_lock lock {mutex_};
+        not_full_.wait(lock, [this]{return queue_.size() < capacity_ || closed_;});
+        if (closed_)
+            return false;
+        queue_.push(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // false if queue is full or closed
+    bool try_push(T value)
+    {
+        std::lock_guard lock {mutex_};
+        if (queue_.size() >= capacity_ || closed_)
+            return false;
+        queue_.push(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop()
+    {
+        std::unique_lock lock {mutex_};
+        not_empty_.wait(lock, [this]{return !queue_.empty() || closed_;});
+        if (queue_.empty())
+            return std::nullopt;
+
+        auto value = std::move(queue_.front());
+        queue_.pop();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void close()
+    {
+        std::lock_guard lock {mutex_};
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+}; // class BoundedQueue
+} // namespace Circuit
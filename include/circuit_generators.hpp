@@ -0,0 +1,181 @@
+#pragma once
+
+#include <random>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+
+#include "edge.hpp"
+#include "matrix_arithmetic.hpp"
+
+namespace Circuit
+{
+namespace Generators
+{
+// Synthetic circuit families. Resistances are uniform in [1, 1000], edge has emf uniform in [-100, 100]
+// with probability emf_probability. Nodes are numbered from 1 as in input of currents.
+// The same seed gives the same circuit.
+using Edges = Container::Vector<InputOutput::InputEdge>;
+
+class EdgeMaker final
+{
+    std::mt19937_64 engine_;
+    std::uniform_real_distribution<double> resistance_ {1.0, 1000.0};
+    std::uniform_real_distribution<double> emf_ {-100.0, 100.0};
+    std::bernoulli_distribution has_emf_;
+
+public:
+    explicit EdgeMaker(std::uint64_t seed, double emf_probability = 0.3)
+    :engine_ {seed}, has_emf_ {emf_probability}
+    {}
+
+    std::mt19937_64& engine() {return engine_;}
+
+    InputOutput::InputEdge operator()(unsigned node1, unsigned node2)
+    {
+        const auto resistance = resistance_(engine_);
+        return InputOutput::InputEdge{node1, node2, resistance, has_emf_(engine_) ? emf_(engine_) : 0.0};
+    }
+}; // class EdgeMaker
+
+template<typename Sink>
+concept EdgeSink = std::invocable<Sink&, const InputOutput::InputEdge&>;
+
+// Every family passes edges to sink one by one, so huge circuits may be written without keeping them in memory,
+// and has overload collecting edges in Edges.
+
+// rows x cols lattice: N = rows * cols, E = rows * (cols - 1) + cols * (rows - 1)
+// Complexity: O(N)
+template<EdgeSink Sink>
+void grid(unsigned rows, unsigned cols, Sink&& sink, std::uint64_t seed = 1)
+{
+    EdgeMaker make_edge {seed};
+    auto node = [cols](unsigned row, unsigned col) {return row * cols + col + 1;};
+    for (unsigned row = 0; row < rows; ++row)
+        for (unsigned col = 0; col < cols; ++col)
+        {
+            if (col + 1 < cols)
+                sink(make_edge(node(row, col), node(row, col + 1)));
+            if (row + 1 < rows)
+                sink(make_edge(node(row, col), node(row + 1, col)));
+        }
+}
+
+// Two rails of rungs + 1 nodes connected with rungs: N = 2 * (rungs + 1), E = 3 * rungs + 1
+// Complexity: O(rungs)
+template<EdgeSink Sink>
+void ladder(unsigned rungs, Sink&& sink, std::uint64_t seed = 1)
+{
+    grid(2, rungs + 1, sink, seed);
+}
+
+// Random spanning tree on number_of_nodes nodes plus extra random edges up to average degree,
+// so circuit is connected: E = max(N - 1, N * average_degree / 2), no extra edges if N < 2
+// Complexity: O(E)
+template<EdgeSink Sink>
+void giant_component(unsigned number_of_nodes, Sink&& sink, double average_degree = 4.0, std::uint64_t seed = 1,
+                     unsigned first_node = 1)
+{
+    if (number_of_nodes == 0)
+        return;
+
+    EdgeMaker make_edge {seed};
+    auto& engine = make_edge.engine();
+    const auto number_of_edges = std::max<std::size_t>(number_of_nodes - 1, number_of_nodes * average_degree / 2);
+
+    for (unsigned node = 1; node < number_of_nodes; ++node) // tree: every node hangs on a random previous one
+        sink(make_edge(std::uniform_int_distribution<unsigned>{0, node - 1}(engine) + first_node, node + first_node));
+    if (number_of_nodes < 2) // no edge without loop on one node
+        return;
+
+    std::uniform_int_distribution<unsigned> random_node {first_node, first_node + number_of_nodes - 1};
+    for (std::size_t i = number_of_nodes - 1; i < number_of_edges;)
+    {
+        const auto node1 = random_node(engine), node2 = random_node(engine);
+        if (node1 != node2)
+        {
+            sink(make_edge(node1, node2));
+            ++i;
+        }
+    }
+}
+
+// number_of_nodes nodes with edges between random pairs: E = N * average_degree / 2, no edges if N < 2.
+// Unlike giant_component() it is not necessarily connected, small average degree gives many isolated parts.
+// Complexity: O(E)
+template<EdgeSink Sink>
+void random_sparse(unsigned number_of_nodes, Sink&& sink, double average_degree = 3.0, std::uint64_t seed = 1)
+{
+    if (number_of_nodes < 2)
+        return;
+
+    EdgeMaker make_edge {seed};
+    std::uniform_int_distribution<unsigned> random_node {1, number_of_nodes};
+    const auto number_of_edges = static_cast<std::size_t>(number_of_nodes * average_degree / 2);
+
+    for (std::size_t i = 0; i < number_of_edges;)
+    {
+        const auto node1 = random_node(make_edge.engine()), node2 = random_node(make_edge.engine());
+        if (node1 != node2)
+        {
+            sink(make_edge(node1, node2));
+            ++i;
+        }
+    }
+}
+
+// number_of_components disjoint giant_component() circuits of component_size nodes each, one after another
+// (overload returning Edges shuffles them)
+// Complexity: O(E)
+template<EdgeSink Sink>
+void many_components(unsigned number_of_components, unsigned component_size, Sink&& sink, double average_degree = 3.0,
+                     std::uint64_t seed = 1)
+{
+    for (unsigned i = 0; i < number_of_components; ++i)
+        giant_component(component_size, sink, average_degree, seed + i, i * component_size + 1);
+}
+
+inline Edges grid(unsigned rows, unsigned cols, std::uint64_t seed = 1)
+{
+    Edges edges {};
+    grid(rows, cols, [&edges](const InputOutput::InputEdge& edge) {edges.push_back(edge);}, seed);
+    return edges;
+}
+
+inline Edges ladder(unsigned rungs, std::uint64_t seed = 1)
+{
+    Edges edges {};
+    ladder(rungs, [&edges](const InputOutput::InputEdge& edge) {edges.push_back(edge);}, seed);
+    return edges;
+}
+
+inline Edges giant_component(unsigned number_of_nodes, double average_degree = 4.0, std::uint64_t seed = 1)
+{
+    Edges edges {};
+    giant_component(number_of_nodes, [&edges](const InputOutput::InputEdge& edge) {edges.push_back(edge);},
+                    average_degree, seed);
+    return edges;
+}
+
+inline Edges random_sparse(unsigned number_of_nodes, double average_degree = 3.0, std::uint64_t seed = 1)
+{
+    Edges edges {};
+    random_sparse(number_of_nodes, [&edges](const InputOutput::InputEdge& edge) {edges.push_back(edge);},
+                  average_degree, seed);
+    return edges;
+}
+
+inline Edges many_components(unsigned number_of_components, unsigned component_size, double average_degree = 3.0,
+                             std::uint64_t seed = 1)
+{
+    Edges edges {};
+    many_components(number_of_components, component_size,
+                    [&edges](const InputOutput::InputEdge& edge) {edges.push_back(edge);}, average_degree, seed);
+
+    std::mt19937_64 engine {seed};
+    for (auto i = edges.size(); i > 1; --i)
+        std::swap(edges[i - 1], edges[std::uniform_int_distribution<std::size_t>{0, i - 1}(engine)]);
+    return edges;
+}
+} // namespace Generators
+} // namespace Circuit
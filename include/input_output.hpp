@@ -2,14 +2,18 @@
 #include "circuit.hpp"
 #include <cassert>
 #include <iterator>
+#include <string>
 
 namespace Circuit
 {
 namespace InputOutput
 {
-Container::Vector<InputEdge> input();
+// Throws std::logic_error or std::invalid_argument if line isn't an edge
+InputEdge scan_edge(const std::string& str);
+
+Container::Vector<InputEdge> input(std::istream& is = std::cin);
 
 using SolutionIt = typename Circuit::Solution::const_iterator;
-void output(SolutionIt first, SolutionIt last);
+void output(SolutionIt first, SolutionIt last, std::ostream& os = std::cout);
 } // namespace InputOutput
 } // namespace Circuit
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "circuit.hpp"
+
+namespace Circuit
+{
+namespace Server
+{
+// Every request and response is a frame: 1 byte of kind, 8 bytes of payload size (uint64_t, native byte order), payload.
+// Request kinds:
+//     text   - payload is circuit in the same form as input of currents
+//     binary - payload is sequence of edges: uint32_t node1, uint32_t node2, double resistance, double emf (24 bytes)
+// Response kinds:
+//     ok     - payload is solution in the same form as output of currents
+//     error  - payload is error message
+// One connection may carry any number of requests, responses are sent in the same order.
+enum class Kind : char
+{
+    text   = 'T',
+    binary = 'B',
+    ok     = 'O',
+    error  = 'E'
+}; // enum Kind
+
+constexpr std::size_t binary_edge_size = 2 * sizeof(std::uint32_t) + 2 * sizeof(double);
+
+struct Frame
+{
+    Kind kind_ = Kind::text;
+    std::string payload_ = {};
+}; // struct Frame
+
+struct ServerOptions
+{
+    std::size_t number_of_workers_ = 0;          // 0 means std::thread::hardware_concurrency()
+    std::size_t cache_size_ = std::size_t{64} << 20; // bytes of requests and responses kept in cache
+    // Bigger request is answered with error frame and its connection is closed
+    std::size_t max_request_size_ = std::size_t{256} << 20;
+    // Connections over this number are answered with error frame and closed
+    std::size_t max_connections_ = 1024;
+    SolverOptions solver_options_ = {};
+}; // struct ServerOptions
+
+// Listens unix domain socket at path until SIGINT, SIGTERM or stop(). Idle connections are polled by run() itself,
+// connection with incoming request is handed to pool of workers for this request only, so idle clients
+// don't hold workers. Worker gives up on client which doesn't send the rest of request or doesn't read
+// response for several seconds. Every worker reuses its buffers between requests. Responses except errors for recently
+// solved requests are cached by content, identical requests being solved at the same time are solved once.
+// On stop reading of every connection is shut down, requests being solved are answered.
+void run(const std::filesystem::path& path, const ServerOptions& options = {});
+
+// Stops running server as SIGINT and SIGTERM do, may be called from any thread. Does nothing if server isn't running
+void stop();
+
+// Edges in binary payload
+std::string encode_binary(const Container::Vector<InputOutput::InputEdge>& edges);
+
+class Client final
+{
+    int socket_ = -1;
+
+public:
+    explicit Client(const std::filesystem::path& path);
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+    ~Client();
+
+    Frame solve(const Frame& request);
+}; // class Client
+} // namespace Server
+} // namespace Circuit
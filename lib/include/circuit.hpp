@@ -7,11 +7,17 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
+#include <span>
+#include <optional>
+#include <stdexcept>
+#include <mutex>
 
 #include "connected_circuit.hpp"
 
 namespace Circuit
 {
+// Const queries memoize solutions of connected circuits under mutex, so they may be called from several threads
+// at once (they are serialized). Non-const methods need exclusive access as usual.
 class Circuit final
 {
 public:
@@ -19,6 +25,7 @@ public:
     using Edges = ConnectedCircuit::Edges;
     using EdgeCur  = typename ConnectedCircuit::EdgeCur;
     using Solution = typename ConnectedCircuit::Solution;
+    using Currents = typename ConnectedCircuit::Currents;
 
 private:
     // C - number of connected circuits in circuit (cirs_.size())
@@ -30,6 +37,63 @@ private:
     // N/C <= MC <= N
     Container::Vector<ConnectedCircuit> cirs_ = {};
     size_type number_of_edges_ = 0, number_of_nodes_ = 0;
+
+    // Place of edge with ind_ == I is edge_places_[I]:
+    // cirs_[edge_places_[I].cir_].edges()[edge_places_[I].pos_]
+    // Indexes of removed edges are not reused, their places are marked as removed_.
+    struct EdgePlace
+    {
+        size_type cir_ = 0, pos_ = 0;
+        bool removed_ = false;
+    }; // struct EdgePlace
+    Container::Vector<EdgePlace> edge_places_ = {};
+
+    // node_cirs_[node] is index of connected circuit in cirs_ which contains node
+    std::unordered_map<unsigned, size_type> node_cirs_ = {};
+
+    // Memoized solutions of connected circuits, const queries read and fill them under mutex_.
+    // Copy of circuit gets copy of solutions and its own mutex.
+    struct Memo
+    {
+        // Solution of connected circuit with options giving it, empty currents mean there is no solution
+        struct Solved
+        {
+            SolverOptions options_ = {};
+            Currents currents_ = {};
+        }; // struct Solved
+
+        // Solutions with this many different options are memoized per connected circuit,
+        // the least recently solved one is forgotten for the next one
+        static constexpr size_type max_solutions = 4;
+
+        // solutions_[I] are memoized solutions of cirs_[I] from the least recently solved one, empty if cirs_[I]
+        // wasn't solved yet
+        Container::Vector<Container::Vector<Solved>> solutions_ = {};
+        mutable std::mutex mutex_ = {};
+
+        Memo() = default;
+        Memo(const Memo& rhs)
+        {
+            std::lock_guard lock {rhs.mutex_};
+            solutions_ = rhs.solutions_;
+        }
+        Memo(Memo&& rhs) noexcept: solutions_ (std::move(rhs.solutions_)) {}
+        Memo& operator=(const Memo& rhs)
+        {
+            if (this != &rhs)
+            {
+                std::scoped_lock lock {mutex_, rhs.mutex_};
+                solutions_ = rhs.solutions_;
+            }
+            return *this;
+        }
+        Memo& operator=(Memo&& rhs) noexcept
+        {
+            solutions_ = std::move(rhs.solutions_);
+            return *this;
+        }
+    }; // struct Memo
+    mutable Memo memo_ = {};
     
     using Nodes = std::unordered_map<unsigned, Container::Vector<std::pair<unsigned, const Edge*>>>;
     using Node  = typename Nodes::value_type;
@@ -112,28 +176,116 @@ public:
     Circuit(InpIt first, InpIt last)
     requires std::is_same<typename std::remove_cvref_t<typename std::iterator_traits<InpIt>::value_type>, InputOutput::InputEdge>::value
     {
+        Stats::Timer split {Stats::Phase::split};
         const auto& edges = make_edges_from_input_edges(first, last); // E iterations
+        edge_places_ = Container::Vector<EdgePlace>(edges.size());
 
+        Stats::Timer nodes_timer {Stats::Phase::make_nodes};
         auto nodes = make_nodes(edges.cbegin(), edges.cend()); // E iterations
+        nodes_timer.stop();
         number_of_nodes_ = nodes.size();
 
-        size_type nodes_placed = 0;
         while (!nodes.empty()) // C iterations
         {
             const auto& connected_cir = make_connected_cir_as_nodes(nodes); // MN * ME iterations
-            cirs_.push_back(make_connected_cir(connected_cir.cbegin(), connected_cir.cend())); // MN * ME iterations
+            push_cir(make_connected_cir(connected_cir.cbegin(), connected_cir.cend())); // MN * ME iterations
             number_of_edges_ += cirs_.back().number_of_edges();
         }
+        Stats::count(Stats::Counter::connected_circuits, cirs_.size());
     }
     
     // Complexity: O(C * MN * ME)
     Circuit(std::initializer_list<InputOutput::InputEdge> ilist): Circuit(ilist.begin(), ilist.end()) {}
 
     size_type number_of_edges() const {return number_of_edges_;}
+    // Edge indexes are in [0, number_of_edge_indexes()), indexes of removed edges are not reused
+    size_type number_of_edge_indexes() const {return edge_places_.size();}
+    bool has_edge(size_type edge_index) const
+    {
+        return edge_index < edge_places_.size() && !edge_places_[edge_index].removed_;
+    }
     size_type number_of_nodes() const {return number_of_nodes_;}
     size_type number_of_connected_circuits() const {return cirs_.size();}
+    const ConnectedCircuit& connected_circuit(size_type cir_index) const {return cirs_[cir_index];}
+
+    // Index of connected circuit with edge with ind_ == edge_index and position of edge in its edges()
+    // Complexity: O(1)
+    std::pair<size_type, size_type> edge_place(size_type edge_index) const;
 
+    // Complexity: O(C)
+    size_type number_of_solved_circuits() const
+    {
+        std::lock_guard lock {memo_.mutex_};
+        return std::count_if(memo_.solutions_.cbegin(), memo_.solutions_.cend(), [](const auto& sol){return sol.size() != 0;});
+    }
+
+private:
+    // Complexity: O(ME)
+    // update edge_places_ and node_cirs_ for edges and nodes of cirs_[cir_index]
+    void place_cir(size_type cir_index);
+
+    // Complexity: O(ME)
+    void push_cir(ConnectedCircuit&& cir);
+
+    // Complexity: O(ME)
+    // marks cirs_[cir_index] as not solved
+    void replace_cir(size_type cir_index, ConnectedCircuit&& cir);
+
+    // Complexity: O(ME)
+    // moves the last connected circuit on place of erased one
+    void erase_cir(size_type cir_index);
+
+    // Complexity: O(1) amortized
+    // appends edge to cirs_[cir_index] and updates edge_places_ and node_cirs_ for it
+    void append_edge(size_type cir_index, const Edge& edge);
+
+    // Caller must hold memo_.mutex_, returned reference is valid while it is held
+    // Complexity: O((MN + ME)^3) for the first call with cir_index and options, O(1) for next ones
+    // while solutions with no more than Memo::max_solutions different options are asked for
+    const Currents& solved_currents(size_type cir_index, const SolverOptions& options) const;
+
+public:
+    // Adds edge and returns its index. Edge is appended to edges of its connected circuit (smaller of two connected
+    // circuits joined by edge is appended to bigger one), only memoized solution of that connected circuit is forgotten
+    // and its slae is rebuilt when it is solved next time.
+    // Complexity: O(1) amortized, O(ME) if edge joins two connected circuits
+    size_type add_edge(const InputOutput::InputEdge& input_edge);
+
+    // Removes edge with ind_ == edge_index, indexes of other edges stay the same.
+    // Connectivity is rechecked only for connected circuit which contained removed edge.
+    // Complexity: O(MN * ME)
+    void remove_edge(size_type edge_index);
+
+    // Complexity: O(1)
+    void change_edge(size_type edge_index, double resistance, double emf);
+
+public:
+    // Current through edge with ind_ == edge_index, std::nullopt if connected circuit with this edge has no solution.
+    // Solves only connected circuit which contains this edge, solution is memoized per options giving it
+    // (see same_solution()) for Memo::max_solutions different options.
+    // Complexity: O((MN + ME)^3) for the first query in connected circuit with options, O(1) for next ones.
+    // Queries cycling through more than Memo::max_solutions different options solve connected circuit every time.
+    std::optional<double> current(size_type edge_index, const SolverOptions& options = {}) const;
+
+    // Complexity: O(K + S * (MN + ME)^3)
+    // K - number of requested edges
+    // S - number of not yet solved connected circuits which contain requested edges
+    Container::Vector<std::optional<double>> currents(std::span<const size_type> edge_indexes,
+                                                      const SolverOptions& options = {}) const;
+
+    // Zero-resistance loops which make connected circuits structurally singular, one loop per such connected circuit
+    // Complexity: O(N + E)
+    Container::Vector<Edges> zero_resistance_loops() const;
+
+    // solution[I] is current through edge with ind_ == I, so it has number_of_edge_indexes() elements.
+    // Removed edges are EdgeCur{}, edges of connected circuits without solution have NaN current.
+    // Connected circuits are solved only if they have no solution memoized with options giving the same one
     // Complexity: O(C * (MN + ME)^3)
-    Solution solve_circuit() const;
+    Solution solve_circuit(const SolverOptions& options = {}) const;
+
+    // Residuals of Kirchhoff's laws for solution returned by solve_circuit(), removed edges and edges with NaN current
+    // (of unsolved connected circuits) are skipped. Throws std::invalid_argument if solution doesn't match edges of circuit.
+    // Complexity: O(N + E)
+    Residuals verify(const Solution& solution) const;
 }; // class Circuit
 } // namespace Circuit
\ No newline at end of file
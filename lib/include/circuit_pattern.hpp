@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "circuit.hpp"
+
+namespace Circuit
+{
+// Topology of circuit which is solved many times with different values of resistances and emfs
+// (Monte Carlo analysis of tolerances). Splitting in connected circuits, node indexes, ordering of nodal slae,
+// structure of its factor and choice of solvers are made once, so every set of values costs only
+// numeric factorization and solve of connected circuits.
+// Set of values must keep sign of every resistance: zero resistances stay zero, negative ones stay negative.
+class CircuitPattern final
+{
+public:
+    using size_type = std::size_t;
+    using Currents  = Container::Vector<double>;
+
+    struct Values
+    {
+        double resistance_ = 0.0, emf_ = 0.0;
+    }; // struct Values
+
+    // ValueSet[I] are values of edge I in input order
+    using ValueSet = Container::Vector<Values>;
+
+private:
+    // C, MN, ME, N and E as in Circuit
+    // S - number of value sets
+
+    struct Component
+    {
+        ConnectedCircuit cir_;
+        ConnectedCircuit::Plan plan_;
+    }; // struct Component
+    Container::Vector<Component> components_ = {};
+
+    // Edge I of input is components_[edge_places_[I].cir_].cir_.edges()[edge_places_[I].pos_]
+    struct EdgePlace
+    {
+        size_type cir_ = 0, pos_ = 0;
+    }; // struct EdgePlace
+    Container::Vector<EdgePlace> edge_places_ = {};
+
+    // signs_[I] is sign of resistance of edge I
+    Container::Vector<signed char> signs_ = {};
+
+    SolverOptions options_ = {};
+
+    static signed char sign(double resistance) {return (resistance > 0.0) ? 1 : (resistance == 0.0) ? 0 : -1;}
+
+    // Complexity: O(C * MN * ME + (N + E) * log(N + E))
+    CircuitPattern(const Circuit& circuit, const SolverOptions& options);
+
+    // Throws std::invalid_argument if values don't fit pattern
+    // Complexity: O(E)
+    void check(const ValueSet& values) const;
+
+    // Connected circuits of pattern are copied in cirs once and then only their values are changed
+    // Complexity: O(E) + numeric factorization and solve of every connected circuit
+    Currents solve(const ValueSet& values, Container::Vector<ConnectedCircuit>& cirs, const SolverOptions& options) const;
+
+    // Complexity: O(E)
+    Container::Vector<ConnectedCircuit> copy_connected_circuits() const;
+
+public:
+    // Log of options is written only while pattern is made
+    // Complexity: O(C * MN * ME + (N + E) * log(N + E))
+    template<std::input_iterator InpIt>
+    CircuitPattern(InpIt first, InpIt last, const SolverOptions& options = {})
+    requires (std::is_same<typename std::remove_cvref_t<typename std::iterator_traits<InpIt>::value_type>,
+    InputOutput::InputEdge>::value)
+    :CircuitPattern(Circuit(first, last), options)
+    {}
+
+    size_type number_of_edges() const {return edge_places_.size();}
+    size_type number_of_connected_circuits() const {return components_.size();}
+
+    // Values of circuit pattern was made from
+    // Complexity: O(E)
+    ValueSet values() const;
+
+    // Currents of edges in input order, NaN for edges of connected circuits without solution.
+    // Throws std::invalid_argument if values don't fit pattern.
+    // Complexity: O(E) + numeric factorization and solve of every connected circuit
+    Currents solve(const ValueSet& values) const;
+
+    // Value sets are distributed among options.number_of_threads_ threads (0 means std::thread::hardware_concurrency()),
+    // every thread copies connected circuits once. Schur solver of every value set gets its share of these threads,
+    // so there are never more threads in total. All value sets are checked before solving.
+    // Complexity: O(S * (E + numeric factorization and solve of every connected circuit))
+    Container::Vector<Currents> solve_batch(const Container::Vector<ValueSet>& value_sets) const;
+}; // class CircuitPattern
+} // namespace Circuit
@@ -4,9 +4,16 @@
 #include <cassert>
 #include <unordered_set>
 #include <set>
+#include <optional>
+#include <stdexcept>
+#include <thread>
 
 #include "matrix_arithmetic.hpp"
 #include "matrix_slae.hpp"
+#include "nodal_slae.hpp"
+#include "residuals.hpp"
+#include "solver_options.hpp"
+#include "stats.hpp"
 #include "edge.hpp"
 
 namespace Circuit
@@ -29,8 +36,13 @@ public:
     using EdgeCur   = std::pair<Edge, double>;
     using Solution  = Container::Vector<EdgeCur>;
     using Edges     = Container::Vector<Edge>;
+    using Currents  = Container::Vector<double>;
     using size_type = typename Edges::size_type;
 
+    // Circuits with N + E not bigger than that are solved with dense solver without estimations:
+    // nodal slae analysis costs more than elimination of such small slae
+    static constexpr size_type tiny_size = 16;
+
 private:
     struct DblCmp
     {
@@ -39,33 +51,20 @@ private:
             return std::abs(d1 - d2) <= (std::abs(d1) + std::abs(d2) + 1) * 1e-8;
         }
     };
+
+public:
     using MatrixSLAE     = Matrix::MatrixSLAE<double, DblCmp>;
     using MatrixIterator = MatrixSLAE::iterator;
-    using Map            = std::unordered_map<unsigned, size_type>;
+
+private:
+    using Map = std::unordered_map<unsigned, size_type>;
 
     // N - number of nodes
     // E - number of edges
 
     Edges edges_ = {};
-    // height() of matrix is N
-    // width()  of matrix is E
-    // If edge I flow in node  J than           mat[I][J] == flow_in (1)
-    // If edge I flow out node J than           mat[I][J] == flow_out (-1) 
-    // If edge I not connected with node J than mat[I][J] == not_connected (0)
-    Matrix::MatrixContainer<connection> incidence_matrix_ = {};
-    
     Map nodes_to_indexis_ = {};
 
-    // Complexity: O(E)
-    template<std::forward_iterator FwdIt>
-    static size_type calc_height(FwdIt first, FwdIt last)
-    {
-        std::unordered_set<unsigned> set_nodes {};
-        for (; first != last; ++first) // E iterations
-            set_nodes.insert({first->node1_, first->node2_});
-        return set_nodes.size();
-    }   
-
     // Complexity: O(E)
     template<std::forward_iterator FwdIt>
     static Map fill_nodes_to_indexis(FwdIt first, FwdIt last)
@@ -100,18 +99,8 @@ private:
 public:
     // Complexity: O(E)
     explicit ConnectedCircuit(Edges&& edges)
-    :edges_ (std::move(edges)), incidence_matrix_ (calc_height(edges_.cbegin(), edges_.cend()), edges_.size()),
-    nodes_to_indexis_ (fill_nodes_to_indexis(edges_.cbegin(), edges_.cend()))
-    {
-        auto first = edges_.cbegin();
-        auto last  = edges_.cend();
-
-        for (size_type i = 0; first != last; ++first, ++i) // E iterations
-        {
-            incidence_matrix_[index(first->node1_)][i] = flow_out;
-            incidence_matrix_[index(first->node2_)][i] = flow_in;
-        }
-    }
+    :edges_ (std::move(edges)), nodes_to_indexis_ (fill_nodes_to_indexis(edges_.cbegin(), edges_.cend()))
+    {}
 
     // Complexity: O(E)
     template<std::input_iterator InpIt>
@@ -134,23 +123,100 @@ public:
     // Complexity: O(E)
     ConnectedCircuit(std::initializer_list<InputOutput::InputEdge> ilist): ConnectedCircuit(ilist.begin(), ilist.end()) {}
     
-    size_type number_of_nodes() const {return incidence_matrix_.height();}
+    size_type number_of_nodes() const {return nodes_to_indexis_.size();}
     size_type number_of_edges() const {return edges_.size();}
+    const Edges& edges() const {return edges_;}
+
+    // Complexity: O(1)
+    void change_edge(size_type pos, double resistance, double emf)
+    {
+        edges_[pos].resistance_ = resistance;
+        edges_[pos].emf_        = emf;
+    }
+
+    // Edge must share a node with the circuit (or join it with another one which edges are added next),
+    // positions of other edges stay the same
+    // Complexity: O(1) amortized
+    void add_edge(const Edge& edge)
+    {
+        edges_.push_back(edge);
+        nodes_to_indexis_.insert(Map::value_type{edge.node1_, nodes_to_indexis_.size()});
+        nodes_to_indexis_.insert(Map::value_type{edge.node2_, nodes_to_indexis_.size()});
+    }
 
 private:
-    // Complexity: O(N * E)
+    // Complexity: O(E)
     // add N - 1 equations in slae matrix
+    // If edge I flow in node  J than           slae[J][I] == flow_in (1)
+    // If edge I flow out node J than           slae[J][I] == flow_out (-1)
+    // If edge I not connected with node J than slae[J][I] == not_connected (0)
     void add_first_Kirchhof_rule_equations(MatrixSLAE& slae) const;
     
-    // Complexity: O(N * E)
+    // Complexity: O(E)
     // add E + 1 equations in sale matrix
     void add_potential_difference_equations(MatrixSLAE& slae) const;
 
+    // Complexity: O((N + E)^3)
+    // empty currents if slae is singular
+    Currents solve_dense() const;
+
+    // Complexity: depends on solver, see NodalSLAE
+    // empty currents if solver failed
+    Currents solve_nodal(const NodalSLAE& nodal, Solver solver, const SolverOptions& options) const;
+
+    // Complexity: O(1)
+    static size_type number_of_threads(const SolverOptions& options);
+
+    // Complexity: O(E)
+    bool has_negative_resistance() const;
+
+    // Complexity: O(E)
+    Solution make_solution(const Currents& currents) const;
+
+public:
+    // Dense slae on currents and potentials which solve_dense() eliminates
     // Complexity: O((N + E)^2)
     MatrixSLAE make_slae() const;
 
+    // Estimation of flops and memory of solver, nodal must be built from edges() for nodal solvers
+    // Complexity: O(1), O(number of parts of nested dissection) for schur solver
+    SolverCost estimate_cost(Solver solver, const NodalSLAE* nodal = nullptr, size_type number_of_domains = 1) const;
+
+    // Solvers in order they are tried by solve_circuit(options): explicitly chosen one first,
+    // then the others fitting in memory budget from the cheapest one. Nodal solvers are considered if nodal isn't nullptr.
+    // If none of them fits in memory budget, the one needing the least memory is taken and it is logged
+    // Complexity: O(N + E)
+    Container::Vector<SolverCost> choose_solvers(const SolverOptions& options, const NodalSLAE* nodal) const;
+
 public:
-    // Complexity: O((N + E)^3)
-    Solution solve_circuit() const;
+    // Residuals of Kirchhoff's laws for currents of edges()
+    // Complexity: O(N + E)
+    Residuals verify(const Currents& currents) const {return compute_residuals(edges_, currents);}
+
+    // Edges of a loop made only of zero-resistance edges (wires and ideal sources), empty if there is no such loop.
+    // Current around such loop is not determined, so slae of circuit with it is structurally singular.
+    // Complexity: O(N + E)
+    Edges find_zero_resistance_loop() const;
+
+    // Part of solving which depends only on nodes of edges and on which resistances are zero or negative,
+    // so it may be reused for circuits differing from this one in values of resistances and emfs
+    struct Plan
+    {
+        bool singular_ = false;                // there is a loop of zero-resistance edges
+        std::optional<NodalSLAE> nodal_ = {};  // symbolic analysis for nodal solvers
+        Container::Vector<SolverCost> solvers_ = {}; // in order they are tried
+    }; // struct Plan
+
+    // Complexity: O((N + E) * log(N + E))
+    Plan make_plan(const SolverOptions& options = {}) const;
+
+    // Currents of edges() with plan made by circuit with the same edges up to values of resistances and emfs,
+    // zero resistances must be the same ones. Empty currents if there is no solution.
+    // If solution of every solver fails verification (see SolverOptions), the one with the least residual is returned
+    // Complexity: O((N + E)^3) for dense solver, see NodalSLAE for the others
+    Currents solve_currents(const Plan& plan, const SolverOptions& options = {}) const;
+
+    // Complexity: O((N + E)^3) for dense solver, see NodalSLAE for the others
+    Solution solve_circuit(const SolverOptions& options = {}) const;
 }; // class ConnectedCircuit
 } // namespace Circuit
\ No newline at end of file
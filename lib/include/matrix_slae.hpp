@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+
 #include "matrix_arithmetic.hpp"
+
 namespace Matrix
 {
 
@@ -46,24 +49,113 @@ public:
         }
     }
 
-    Container::Vector<value_type> solve_slae() const
+    // Gauss elimination with partial pivoting.
+    // Rows and then columns are scaled to the biggest coefficient 1 (equilibration), so coefficients
+    // of very different magnitude (e.g. resistances next to incidence entries) don't hide ordinary pivots.
+    // Slae is considered singular if it has a zero row or column or if the biggest pivot candidate is negligible
+    // relative to the biggest coefficient met during elimination (pivot growth is taken into account),
+    // so no determinant is computed: it underflows or overflows on big systems.
+    // Number of row interchanges is added to *number_of_pivots if it isn't nullptr.
+    Container::Vector<value_type> solve_slae(size_type* number_of_pivots = nullptr) const
     {
         if (!is_matrix_of_slae())
             throw std::invalid_argument{"This Matrix isn't slae"};
 
         MatrixSLAE cpy (*this);
+        const auto n = cpy.height();
+        Abs abs {};
 
-        cpy.make_upper_triangular_square(cpy.height());
-        if (this->cmp(cpy.determinant_for_upper_triangular(cpy.height()), value_type{}))
+        // x[j] == y[j] * column_scales[j] where y is solution of equilibrated slae
+        Container::Vector<value_type> column_scales (n);
+        if (!equilibrate(cpy, column_scales))
             return Container::Vector<value_type>{};
-        cpy.make_eye_square_from_upper_triangular_square(cpy.height());
 
-        Container::Vector<value_type> solution {};
-        solution.reserve(cpy.height());
-        for (auto& row: cpy)
-            solution.push_back(std::move(row.back()));
+        value_type max_coef {};
+        for (const auto& row: cpy)
+            for (size_type j = 0; j < n; ++j)
+                max_coef = std::max(max_coef, abs(row[j]));
+        if (this->cmp(max_coef, value_type{}))
+            return Container::Vector<value_type>{};
+
+        for (size_type k = 0; k < n; ++k)
+        {
+            auto pivot_row = k;
+            for (auto i = k + 1; i < n; ++i)
+                if (abs(cpy[i][k]) > abs(cpy[pivot_row][k]))
+                    pivot_row = i;
+
+            if (this->cmp(abs(cpy[pivot_row][k]) / max_coef, value_type{}))
+                return Container::Vector<value_type>{};
+            if (pivot_row != k)
+            {
+                std::swap_ranges(cpy[k].begin(), cpy[k].end(), cpy[pivot_row].begin());
+                if (number_of_pivots != nullptr)
+                    ++*number_of_pivots;
+            }
+
+            const auto& pivot = cpy[k][k];
+            for (auto i = k + 1; i < n; ++i)
+            {
+                auto& row = cpy[i];
+                if (row[k] == value_type{})
+                    continue;
+
+                const auto factor = row[k] / pivot;
+                row[k] = value_type{};
+                for (auto j = k + 1; j < n; ++j)
+                {
+                    row[j] -= factor * cpy[k][j];
+                    max_coef = std::max(max_coef, abs(row[j]));
+                }
+                row[n] -= factor * cpy[k][n];
+            }
+        }
+
+        Container::Vector<value_type> solution (n);
+        for (auto k = n; k-- > 0;)
+        {
+            auto value = cpy[k][n];
+            for (auto j = k + 1; j < n; ++j)
+                value -= cpy[k][j] * solution[j];
+            solution[k] = value / cpy[k][k];
+        }
+        for (size_type j = 0; j < n; ++j)
+            solution[j] *= column_scales[j];
 
         return solution;
     }
+
+private:
+    // Divides every row by its biggest coefficient and then every column by its one, false if some is zero
+    static bool equilibrate(MatrixSLAE& slae, Container::Vector<value_type>& column_scales)
+    {
+        const auto n = slae.height();
+        Abs abs {};
+        for (auto& row: slae)
+        {
+            value_type max_coef {};
+            for (size_type j = 0; j < n; ++j)
+                max_coef = std::max(max_coef, abs(row[j]));
+            if (max_coef == value_type{})
+                return false;
+            for (auto& coef: row) // right part too
+                coef /= max_coef;
+        }
+
+        std::fill(column_scales.begin(), column_scales.end(), value_type{});
+        for (const auto& row: slae)
+            for (size_type j = 0; j < n; ++j)
+                column_scales[j] = std::max(column_scales[j], abs(row[j]));
+        for (size_type j = 0; j < n; ++j)
+        {
+            if (column_scales[j] == value_type{})
+                return false;
+            column_scales[j] = value_type{1} / column_scales[j];
+        }
+        for (auto& row: slae)
+            for (size_type j = 0; j < n; ++j)
+                row[j] *= column_scales[j];
+        return true;
+    }
 }; // class MatrixSLAE
 } // namespace Matrix
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <unordered_map>
+#include <limits>
+#include <utility>
+
+#include "matrix_arithmetic.hpp"
+#include "edge.hpp"
+
+namespace Circuit
+{
+// Nodal slae of connected circuit: conductance matrix on node potentials.
+// Nodes connected with zero-resistance edges are merged in one supernode (potentials of its nodes
+// differ by emf of these edges), potential of supernode 0 is 0. If all resistances are positive and there
+// is no loop of zero-resistance edges, matrix of slae is symmetric positive definite.
+// Everything computed in constructor depends only on topology and on which edges have zero resistance,
+// so the same NodalSLAE solves circuits which differ only in nonzero resistances and emfs.
+class NodalSLAE final
+{
+public:
+    using size_type = std::size_t;
+    using Edges     = Container::Vector<Edge>;
+    using Currents  = Container::Vector<double>;
+
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    struct NodalMatrix
+    {
+        Container::Vector<double> diag_   = {};
+        Container::Vector<double> values_ = {}; // values of cols_
+        Container::Vector<double> rhs_    = {};
+    }; // struct NodalMatrix
+
+private:
+    // N - number of nodes
+    // E - number of edges
+    // M - number of unknown potentials (number of supernodes - 1)
+    // Z - number of nonzero off-diagonal elements of matrix (Z <= 2 * E)
+    // W - size of envelope: sum of row widths from the first nonzero element to diagonal
+
+    struct EdgeNodes
+    {
+        size_type node1_ = 0, node2_ = 0;
+    }; // struct EdgeNodes
+    Container::Vector<EdgeNodes> edge_nodes_ = {};
+    Container::Vector<bool> zero_resistance_ = {};
+    size_type number_of_nodes_ = 0;
+
+    // Nodes in BFS order of zero-resistance trees, tree_parents_[node] is edge to parent node or npos for roots
+    Container::Vector<size_type> tree_order_   = {};
+    Container::Vector<size_type> tree_parents_ = {};
+
+    // rows_[node] - row of node supernode in matrix, npos for nodes of ground supernode
+    Container::Vector<size_type> rows_ = {};
+    size_type number_of_rows_ = 0;
+
+    // Off-diagonal elements in compressed rows: columns of row I are cols_[row_starts_[I]...row_starts_[I + 1]]
+    Container::Vector<size_type> row_starts_ = {};
+    Container::Vector<size_type> cols_       = {};
+    // Positions of edge conductance in cols_ for elements (row1, row2) and (row2, row1), npos if edge isn't there
+    struct EdgePositions
+    {
+        size_type pos12_ = npos, pos21_ = npos;
+    }; // struct EdgePositions
+    Container::Vector<EdgePositions> edge_positions_ = {};
+
+    // Row I of envelope holds elements from first_cols_[I] to I in env_starts_[I]...env_starts_[I + 1]
+    Container::Vector<size_type> first_cols_ = {};
+    Container::Vector<size_type> env_starts_ = {};
+    double envelope_flops_ = 0.0;
+    size_type number_of_levels_ = 0;
+
+    // Nested dissection of schur solver: row dissection_rows_[K] is eliminated K-th,
+    // dissection_positions_ is inverse permutation. Part of dissection holds positions [begin_, end_):
+    // its subparts first, then its separator [separator_, end_) which disconnects them. Leaf part has no subparts,
+    // all its rows are in [separator_, end_) with separator_ == begin_.
+    struct Part
+    {
+        size_type begin_ = 0, separator_ = 0, end_ = 0, depth_ = 0;
+    }; // struct Part
+    Container::Vector<size_type> dissection_rows_      = {};
+    Container::Vector<size_type> dissection_positions_ = {};
+    Container::Vector<Part>      parts_                = {};
+    // Parts with no more rows than that aren't dissected
+    static constexpr size_type dissection_leaf_size = 64;
+
+    // Sparse Cholesky factor in dissection order: column K holds factor_starts_[K]...factor_starts_[K + 1],
+    // etree_parents_[K] - parent of K in elimination tree (npos for roots), factor_flops_[K] - flops of columns before K
+    Container::Vector<size_type> etree_parents_ = {};
+    Container::Vector<size_type> factor_starts_ = {};
+    Container::Vector<double>    factor_flops_  = {};
+
+    // Complexity: O(N + E)
+    void make_supernodes();
+
+    // Complexity: O(N + E * log(E))
+    // Reverse Cuthill-McKee ordering of supernodes, fills rows_ and compressed rows
+    void make_rows();
+
+    // Complexity: O(M + Z)
+    void make_envelope();
+
+    // Complexity: O((M + Z) * log(M))
+    void make_dissection();
+
+    // Dissects rows in separators of middle BFS level from pseudo-peripheral row, disconnected rows are split
+    // without separator. stamps and levels are workspaces of M elements
+    // Complexity: O((R + Z_R) * log(R)), R - number of rows, Z_R - their nonzeros
+    void dissect(Container::Vector<size_type>&& rows, size_type depth,
+                 Container::Vector<size_type>& stamps, Container::Vector<size_type>& levels);
+
+    // Elimination tree and column counts of factor (Gilbert, Ng, Peyton)
+    // Complexity: O(M + Z * α(M))
+    void make_factor_structure();
+
+    // Cholesky factorization in place of symmetric matrix in envelope form,
+    // false if matrix isn't positive definite
+    // Complexity: O(sum of squared row widths)
+    static bool factorize_envelope(const Container::Vector<size_type>& first_cols, const Container::Vector<size_type>& starts,
+                                   Container::Vector<double>& envelope);
+
+    // Solves L * L^T * x == rhs in place of rhs, envelope is factorized by factorize_envelope()
+    // Complexity: O(size of envelope)
+    static void solve_factorized(const Container::Vector<size_type>& first_cols, const Container::Vector<size_type>& starts,
+                                 const Container::Vector<double>& envelope, Container::Vector<double>& rhs);
+
+    // Ranges of positions [first, second) eliminated in parallel in stages of schur solver:
+    // subtrees of parts of depth D = ceil(log2(K)) (and leaf parts above them) first, then separators of depth D - 1,
+    // D - 2, ... 0. Ranges of one stage depend only on previous stages.
+    // Complexity: O(number of parts)
+    using Range = std::pair<size_type, size_type>;
+    Container::Vector<Container::Vector<Range>> dissection_stages(size_type number_of_domains) const;
+
+    // Numeric factorization of sparse Cholesky factor of schur solver
+    struct Factor;
+
+    // Up-looking factorization of rows [first, last), false if matrix isn't positive definite. stack is workspace of M elements
+    // Complexity: O(sum of squared counts of columns [first, last) of factor)
+    bool eliminate_dissection(const NodalMatrix& matrix, size_type first, size_type last,
+                              Factor& factor, Container::Vector<size_type>& stack) const;
+
+public:
+    // Complexity: O((N + E) * log(N + E))
+    explicit NodalSLAE(const Edges& edges);
+
+    size_type number_of_nodes() const {return number_of_nodes_;}
+    size_type number_of_edges() const {return edge_nodes_.size();}
+    size_type number_of_rows() const {return number_of_rows_;}
+    size_type number_of_nonzeros() const {return cols_.size();}
+    size_type envelope_size() const {return env_starts_.back();}
+    // Number of BFS levels met by ordering, estimation of graph diameter
+    size_type number_of_levels() const {return number_of_levels_;}
+    double envelope_flops() const {return envelope_flops_;}
+    // Number of nonzero elements of sparse Cholesky factor in nested dissection order
+    size_type factor_size() const {return factor_starts_.back();}
+
+    // Edges must have the same topology and zero resistances as edges NodalSLAE was built from
+    // Complexity: O(N + E)
+    Container::Vector<double> make_offsets(const Edges& edges) const;
+
+    // Complexity: O(M + E)
+    NodalMatrix make_matrix(const Edges& edges, const Container::Vector<double>& offsets) const;
+
+    // Potentials of rows, empty if matrix isn't positive definite
+    // Complexity: O(M + W + sum of squared row widths)
+    Container::Vector<double> solve_envelope(const NodalMatrix& matrix) const;
+
+    // Estimated time of factorization of schur solver in K threads in flops: every stage of dissection_stages(K)
+    // lasts as its longest range or its flops divided by K
+    // Complexity: O(number of parts)
+    double dissection_flops(size_type number_of_domains) const;
+
+    // Potentials of rows, empty if matrix isn't positive definite.
+    // Sparse Cholesky factorization in nested dissection order: subdomains (subtrees of dissection) are eliminated
+    // in K parallel threads, then Schur complements on their separators are eliminated level by level,
+    // separators of one level in parallel
+    // Complexity: O(F + L), F - flops of factor, L - its size (factor_size())
+    Container::Vector<double> solve_schur(const NodalMatrix& matrix, size_type number_of_domains) const;
+
+    // Potentials of rows, empty if method didn't converge in 2 * M + 10 iterations
+    // Complexity: O(I * (M + Z)), I - number of iterations
+    Container::Vector<double> solve_conjugate_gradient(const NodalMatrix& matrix, double tolerance) const;
+
+    // Currents of edges from potentials of rows
+    // Complexity: O(N + E)
+    Currents make_currents(const Edges& edges, const Container::Vector<double>& offsets,
+                           const Container::Vector<double>& potentials) const;
+}; // class NodalSLAE
+} // namespace Circuit
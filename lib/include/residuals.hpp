@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include "matrix_arithmetic.hpp"
+
+namespace Circuit
+{
+// Residuals of Kirchhoff's laws for currents of edges, no slae is solved to compute them.
+// Residual of the first law at node:  |sum of currents flowing in node - sum of currents flowing out|
+// Residual of the second law at edge: |phi1 - phi2 + emf - resistance * current|
+// Both are relative to scale of connected part of circuit: max of |current| and |emf| / resistance
+// and max of |emf| + |resistance * current| over its edges, so rounding errors of nearly zero currents
+// don't look like violated laws.
+// Potentials are reconstructed along BFS spanning forest of edges (residuals of forest edges are 0), so the second law
+// is checked for every loop which closes on the other edges.
+// Edge with NaN current is unsolved: it takes part in none of laws and its nodes are not checked.
+struct Residuals
+{
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    double max_kcl_ = 0.0, rms_kcl_ = 0.0;
+    double max_kvl_ = 0.0, rms_kvl_ = 0.0;
+    unsigned worst_node_ = 0;    // node with max_kcl_
+    size_type worst_edge_ = npos; // position of edge with max_kvl_
+    size_type number_of_checked_nodes_ = 0, number_of_checked_edges_ = 0;
+    size_type number_of_unsolved_edges_ = 0;
+
+    double max() const {return std::max(max_kcl_, max_kvl_);}
+}; // struct Residuals
+
+// edges[I] has node1_, node2_, resistance_ and emf_, currents[I] flows from node1_ to node2_
+// Complexity: O(N + E)
+template<typename Edges, typename Currents>
+Residuals compute_residuals(const Edges& edges, const Currents& currents)
+{
+    using size_type = Residuals::size_type;
+    constexpr auto npos = Residuals::npos;
+
+    // N - number of nodes
+    // E - number of edges
+
+    std::unordered_map<unsigned, size_type> indexes {};
+    Container::Vector<unsigned> nodes {};
+    auto index = [&](unsigned node)
+    {
+        const auto [itr, inserted] = indexes.emplace(node, nodes.size());
+        if (inserted)
+            nodes.push_back(node);
+        return itr->second;
+    };
+
+    const auto number_of_edges = edges.size();
+    Container::Vector<size_type> node1s {}, node2s {};
+    node1s.reserve(number_of_edges);
+    node2s.reserve(number_of_edges);
+    for (const auto& edge: edges) // E iterations
+    {
+        node1s.push_back(index(edge.node1_));
+        node2s.push_back(index(edge.node2_));
+    }
+    const auto number_of_nodes = nodes.size();
+
+    Residuals residuals {};
+    auto solved = [&currents](size_type i) {return !std::isnan(currents[i]);};
+
+    // Adjacency of solved edges in compressed rows
+    Container::Vector<size_type> starts (number_of_nodes + 1);
+    for (size_type i = 0; i < number_of_edges; ++i) // E iterations
+        if (solved(i))
+        {
+            ++starts[node1s[i] + 1];
+            ++starts[node2s[i] + 1];
+        }
+        else
+            ++residuals.number_of_unsolved_edges_;
+    for (size_type node = 0; node < number_of_nodes; ++node) // N iterations
+        starts[node + 1] += starts[node];
+    Container::Vector<size_type> adjacent (starts[number_of_nodes]), filled (starts);
+    for (size_type i = 0; i < number_of_edges; ++i) // E iterations
+        if (solved(i))
+        {
+            adjacent[filled[node1s[i]]++] = i;
+            adjacent[filled[node2s[i]]++] = i;
+        }
+
+    // Potentials along BFS forest: phi2 == phi1 + emf - resistance * current for forest edges
+    constexpr auto unknown = std::numeric_limits<double>::quiet_NaN();
+    Container::Vector<double> potentials (number_of_nodes);
+    std::fill(potentials.begin(), potentials.end(), unknown);
+    Container::Vector<size_type> components (number_of_nodes);
+    size_type number_of_components = 0;
+    Container::Vector<size_type> queue {};
+    queue.reserve(number_of_nodes);
+    for (size_type root = 0; root < number_of_nodes; ++root) // N + E iterations in total
+    {
+        if (!std::isnan(potentials[root]))
+            continue;
+        potentials[root] = 0.0;
+        components[root] = number_of_components++;
+        queue.push_back(root);
+        for (size_type first = queue.size() - 1; first < queue.size(); ++first)
+        {
+            const auto node = queue[first];
+            for (auto pos = starts[node]; pos < starts[node + 1]; ++pos)
+            {
+                const auto i = adjacent[pos];
+                const auto& edge = edges[i];
+                const auto voltage = edge.emf_ - edge.resistance_ * currents[i];
+                const auto next = (node1s[i] == node) ? node2s[i] : node1s[i];
+                if (std::isnan(potentials[next]))
+                {
+                    potentials[next] = (node1s[i] == node) ? potentials[node] + voltage : potentials[node] - voltage;
+                    components[next] = components[node];
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+
+    Container::Vector<double> current_scales (number_of_components), voltage_scales (number_of_components);
+    for (size_type i = 0; i < number_of_edges; ++i) // E iterations
+    {
+        if (!solved(i))
+            continue;
+        const auto& edge = edges[i];
+        const auto component = components[node1s[i]];
+        const auto own_current = (edge.resistance_ > 0.0) ? std::abs(edge.emf_) / edge.resistance_ : 0.0;
+        current_scales[component] = std::max({current_scales[component], std::abs(currents[i]), own_current});
+        voltage_scales[component] = std::max(voltage_scales[component],
+                                             std::abs(edge.emf_) + std::abs(edge.resistance_ * currents[i]));
+    }
+    auto relative = [](double residual, double scale) {return (scale > 0.0) ? residual / scale : residual;};
+
+    // The first law
+    Container::Vector<double> sums (number_of_nodes);
+    Container::Vector<bool> unchecked (number_of_nodes);
+    for (size_type i = 0; i < number_of_edges; ++i) // E iterations
+    {
+        if (!solved(i))
+        {
+            unchecked[node1s[i]] = true;
+            unchecked[node2s[i]] = true;
+            continue;
+        }
+        sums[node1s[i]] -= currents[i];
+        sums[node2s[i]] += currents[i];
+    }
+    for (size_type node = 0; node < number_of_nodes; ++node) // N iterations
+    {
+        if (unchecked[node])
+            continue;
+        const auto residual = relative(std::abs(sums[node]), current_scales[components[node]]);
+        residuals.rms_kcl_ += residual * residual;
+        if (residual > residuals.max_kcl_ || residuals.number_of_checked_nodes_ == 0)
+        {
+            residuals.max_kcl_ = residual;
+            residuals.worst_node_ = nodes[node];
+        }
+        ++residuals.number_of_checked_nodes_;
+    }
+
+    // The second law
+    for (size_type i = 0; i < number_of_edges; ++i) // E iterations
+    {
+        if (!solved(i))
+            continue;
+        const auto& edge = edges[i];
+        const auto drop = potentials[node1s[i]] - potentials[node2s[i]];
+        const auto residual = relative(std::abs(drop + edge.emf_ - edge.resistance_ * currents[i]),
+                                       voltage_scales[components[node1s[i]]]);
+        residuals.rms_kvl_ += residual * residual;
+        if (residual > residuals.max_kvl_ || residuals.worst_edge_ == npos)
+        {
+            residuals.max_kvl_ = residual;
+            residuals.worst_edge_ = i;
+        }
+        ++residuals.number_of_checked_edges_;
+    }
+
+    if (residuals.number_of_checked_nodes_ != 0)
+        residuals.rms_kcl_ = std::sqrt(residuals.rms_kcl_ / residuals.number_of_checked_nodes_);
+    if (residuals.number_of_checked_edges_ != 0)
+        residuals.rms_kvl_ = std::sqrt(residuals.rms_kvl_ / residuals.number_of_checked_edges_);
+    return residuals;
+}
+} // namespace Circuit
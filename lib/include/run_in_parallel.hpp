@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Circuit
+{
+// Calls func(I) for I in [0, number) in separate threads, the first exception is rethrown in caller thread
+template<typename F>
+void run_in_parallel(std::size_t number, F func)
+{
+    if (number == 1)
+    {
+        func(0);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors (number);
+    std::vector<std::thread> threads {};
+    threads.reserve(number);
+    for (std::size_t i = 0; i < number; ++i)
+        threads.emplace_back([&func, &errors, i]
+        {
+            try {
+                func(i);
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    for (auto& thread: threads)
+        thread.join();
+
+    for (const auto& error: errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+} // namespace Circuit
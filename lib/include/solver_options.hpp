@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+namespace Circuit
+{
+enum class Solver
+{
+    automatic,          // the cheapest solver which fits in memory budget
+    dense,              // Gauss elimination of dense slae on currents and potentials
+    envelope,           // Cholesky factorization of nodal slae in envelope (profile) form after RCM ordering
+    conjugate_gradient, // Jacobi preconditioned conjugate gradient on nodal slae
+    schur               // Sparse Cholesky factorization of nodal slae in nested dissection order: subdomains are eliminated
+                        // in parallel, then Schur complements on their separators level by level
+}; // enum class Solver
+
+inline const char* solver_name(Solver solver)
+{
+    switch (solver)
+    {
+        case Solver::automatic:          return "automatic";
+        case Solver::dense:              return "dense";
+        case Solver::envelope:           return "envelope";
+        case Solver::conjugate_gradient: return "conjugate_gradient";
+        case Solver::schur:              return "schur";
+    }
+    return "unknown";
+}
+
+struct SolverOptions
+{
+    Solver solver_ = Solver::automatic;
+    // Automatic choice doesn't take solver which needs more memory unless none fits (then the one needing
+    // the least memory is taken), explicitly chosen solver ignores it
+    std::size_t memory_budget_ = std::size_t{1} << 30;
+    // Relative residual at which conjugate gradient stops
+    double tolerance_ = 1e-10;
+    // Number of threads of schur solver, 0 means std::thread::hardware_concurrency()
+    std::size_t number_of_threads_ = 0;
+    // If it isn't 0, solution is accepted only if max residual of Kirchhoff's laws (see residuals.hpp) isn't bigger,
+    // otherwise connected circuit is solved again with more robust solver: conjugate gradient -> envelope or schur -> dense.
+    // Verification costs O(N + E)
+    double verification_tolerance_ = 0.0;
+    // Chosen solvers are logged here if it isn't nullptr
+    std::ostream* log_ = nullptr;
+}; // struct SolverOptions
+
+// Options give the same solution: all fields but log_ are equal
+inline bool same_solution(const SolverOptions& lhs, const SolverOptions& rhs)
+{
+    return lhs.solver_ == rhs.solver_ && lhs.memory_budget_ == rhs.memory_budget_ && lhs.tolerance_ == rhs.tolerance_
+        && lhs.number_of_threads_ == rhs.number_of_threads_ && lhs.verification_tolerance_ == rhs.verification_tolerance_;
+}
+
+// Solution of more robust solver is trusted more: iterative one may stop early, Cholesky factorization
+// fails on indefinite matrices, Gauss elimination with pivoting works on any nonsingular slae
+inline int robustness(Solver solver)
+{
+    switch (solver)
+    {
+        case Solver::conjugate_gradient: return 0;
+        case Solver::envelope:
+        case Solver::schur:              return 1;
+        default:                         return 2;
+    }
+}
+
+// Estimation of solver cost for connected circuit
+struct SolverCost
+{
+    Solver solver_ = Solver::dense;
+    double flops_ = 0.0;
+    std::size_t memory_ = 0; // bytes
+}; // struct SolverCost
+} // namespace Circuit
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+#include "matrix_arithmetic.hpp"
+#include "solver_options.hpp"
+
+namespace Circuit
+{
+// Instrumentation of solving: wall time, allocated bytes and growth of peak RSS of phases, statistics of solved
+// connected circuits and counters. It is disabled by default, then every probe costs one relaxed atomic load.
+// Allocated bytes are counted only if program replaces operator new with one calling Stats::count_allocation()
+// (currents does), they are counted in all threads, so phases running in parallel share them.
+namespace Stats
+{
+enum class Phase
+{
+    parse,       // reading and parsing of input
+    split,       // splitting circuit in connected circuits, includes make_nodes
+    make_nodes,  // adjacency map of nodes built by Circuit
+    analysis,    // symbolic analysis of nodal slae: supernodes, ordering, envelope
+    assembly,    // dense slae or nodal matrix
+    elimination, // solving of slae and recovery of currents
+    output,      // formatting of solution
+    number_of_phases
+}; // enum class Phase
+
+inline const char* phase_name(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::parse:       return "parse";
+        case Phase::split:       return "split";
+        case Phase::make_nodes:  return "make_nodes";
+        case Phase::analysis:    return "analysis";
+        case Phase::assembly:    return "assembly";
+        case Phase::elimination: return "elimination";
+        case Phase::output:      return "output";
+        default:                 return "unknown";
+    }
+}
+
+enum class Counter
+{
+    connected_circuits,            // connected circuits made by Circuit
+    pivots,                        // row interchanges of dense Gauss elimination
+    conjugate_gradient_iterations,
+    solver_failures,               // solvers which failed and were replaced with the next ones
+    verification_failures,         // solutions rejected by residual verification
+    number_of_counters
+}; // enum class Counter
+
+inline const char* counter_name(Counter counter)
+{
+    switch (counter)
+    {
+        case Counter::connected_circuits:            return "connected_circuits";
+        case Counter::pivots:                        return "pivots";
+        case Counter::conjugate_gradient_iterations: return "conjugate_gradient_iterations";
+        case Counter::solver_failures:               return "solver_failures";
+        case Counter::verification_failures:         return "verification_failures";
+        default:                                     return "unknown";
+    }
+}
+
+constexpr auto number_of_phases   = static_cast<std::size_t>(Phase::number_of_phases);
+constexpr auto number_of_counters = static_cast<std::size_t>(Counter::number_of_counters);
+constexpr auto number_of_solvers  = static_cast<std::size_t>(Solver::schur) + 1;
+// Report keeps details of that many the slowest connected circuits, the others are only in histograms
+constexpr std::size_t number_of_slowest_components = 32;
+
+struct PhaseStats
+{
+    std::size_t calls_ = 0;
+    double seconds_ = 0.0;
+    std::size_t allocated_bytes_ = 0;
+    // Growth of peak RSS of process during calls of phase, phases running at the same time share it
+    std::size_t peak_rss_growth_kb_ = 0;
+}; // struct PhaseStats
+
+struct ComponentStats
+{
+    std::size_t nodes_ = 0, edges_ = 0;
+    Solver solver_ = Solver::automatic; // solver which gave solution, automatic if there is no solution
+    double seconds_ = 0.0, assembly_seconds_ = 0.0, elimination_seconds_ = 0.0;
+    std::size_t allocated_bytes_ = 0;
+    std::size_t pivots_ = 0;
+}; // struct ComponentStats
+
+struct Report
+{
+    double seconds_ = 0.0; // since enable()
+    std::size_t allocated_bytes_ = 0;
+    std::size_t peak_rss_kb_ = 0; // of process, at report()
+    std::array<PhaseStats, number_of_phases> phases_ = {};
+    std::array<std::size_t, number_of_counters> counters_ = {};
+    std::array<std::size_t, number_of_solvers> solvers_ = {}; // connected circuits solved by solver, automatic - unsolved
+    // Histograms of connected circuits: histogram[I] is number of ones with [2^I, 2^(I+1)) nodes (edges), I = 0 for 0 and 1
+    Container::Vector<std::size_t> nodes_histogram_ = {};
+    Container::Vector<std::size_t> edges_histogram_ = {};
+    Container::Vector<ComponentStats> slowest_components_ = {}; // from the slowest one
+}; // struct Report
+
+namespace detail
+{
+inline std::atomic<bool> enabled {false};
+inline std::atomic<std::size_t> allocated_bytes {0};
+} // namespace detail
+
+inline bool enabled() {return detail::enabled.load(std::memory_order_relaxed);}
+
+inline void count_allocation(std::size_t size)
+{
+    if (enabled())
+        detail::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+inline std::size_t allocated_bytes() {return detail::allocated_bytes.load(std::memory_order_relaxed);}
+
+// Clears all statistics and starts recording
+void enable();
+void disable();
+
+// Peak resident set size of process in kilobytes
+std::size_t peak_rss_kb();
+
+void add_phase(Phase phase, double seconds, std::size_t allocated_bytes, std::size_t peak_rss_growth_kb);
+
+// Counter is added to connected circuit solved in this thread too
+void count(Counter counter, std::size_t value = 1);
+
+Report report();
+
+// Complexity: O(size of report)
+void write_json(std::ostream& os, const Report& report);
+
+// Measures phase from construction to stop() or destruction
+class Timer final
+{
+    using clock = std::chrono::steady_clock;
+
+    Phase phase_;
+    bool active_ = false;
+    clock::time_point start_ = {};
+    std::size_t start_bytes_ = 0;
+    std::size_t start_rss_kb_ = 0;
+
+    void record();
+
+public:
+    explicit Timer(Phase phase)
+    :phase_ {phase}, active_ {enabled()}
+    {
+        if (active_)
+        {
+            start_ = clock::now();
+            start_bytes_ = allocated_bytes();
+            start_rss_kb_ = peak_rss_kb();
+        }
+    }
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+    // Records phase, assembly and elimination are added to connected circuit solved in this thread
+    void stop()
+    {
+        if (active_)
+            record();
+        active_ = false;
+    }
+
+    ~Timer() {stop();}
+}; // class Timer
+
+// Records statistics of connected circuit solved by this thread from construction to destruction
+class ComponentScope final
+{
+    using clock = std::chrono::steady_clock;
+
+    ComponentStats stats_ = {};
+    ComponentStats* previous_ = nullptr;
+    bool active_ = false;
+    clock::time_point start_ = {};
+    std::size_t start_bytes_ = 0;
+
+    void start();
+    void finish();
+
+public:
+    ComponentScope(std::size_t nodes, std::size_t edges)
+    :stats_ {nodes, edges}, active_ {enabled()}
+    {
+        if (active_)
+            start();
+    }
+
+    ComponentScope(const ComponentScope&) = delete;
+    ComponentScope& operator=(const ComponentScope&) = delete;
+
+    void set_solver(Solver solver) {stats_.solver_ = solver;}
+
+    ~ComponentScope()
+    {
+        if (active_)
+            finish();
+    }
+}; // class ComponentScope
+} // namespace Stats
+} // namespace Circuit
@@ -2,18 +2,257 @@
 
 namespace Circuit
 {
-// Complexity: O(С * (MN + ME)^3)
-auto Circuit::solve_circuit() const -> Solution
+// Complexity: O(ME)
+void Circuit::place_cir(size_type cir_index)
+{
+    const auto& edges = cirs_[cir_index].edges();
+    for (size_type i = 0; i < edges.size(); ++i) // ME iterations
+    {
+        edge_places_[edges[i].ind_] = EdgePlace{cir_index, i};
+        node_cirs_[edges[i].node1_] = cir_index;
+        node_cirs_[edges[i].node2_] = cir_index;
+    }
+}
+
+// Complexity: O(ME)
+void Circuit::push_cir(ConnectedCircuit&& cir)
+{
+    cirs_.push_back(std::move(cir));
+    memo_.solutions_.push_back({});
+    place_cir(cirs_.size() - 1); // ME iterations
+}
+
+// Complexity: O(ME)
+void Circuit::replace_cir(size_type cir_index, ConnectedCircuit&& cir)
+{
+    cirs_[cir_index] = std::move(cir);
+    memo_.solutions_[cir_index].clear();
+    place_cir(cir_index); // ME iterations
+}
+
+// Complexity: O(ME)
+void Circuit::erase_cir(size_type cir_index)
+{
+    if (cir_index != cirs_.size() - 1)
+    {
+        cirs_[cir_index]     = std::move(cirs_.back());
+        memo_.solutions_[cir_index] = std::move(memo_.solutions_.back());
+        place_cir(cir_index); // ME iterations
+    }
+    cirs_.pop_back();
+    memo_.solutions_.pop_back();
+}
+
+// Complexity: O(1) amortized
+void Circuit::append_edge(size_type cir_index, const Edge& edge)
+{
+    cirs_[cir_index].add_edge(edge);
+    edge_places_[edge.ind_] = EdgePlace{cir_index, cirs_[cir_index].number_of_edges() - 1};
+    node_cirs_[edge.node1_] = cir_index;
+    node_cirs_[edge.node2_] = cir_index;
+}
+
+// Complexity: O(1) amortized, O(ME) if edge joins two connected circuits
+auto Circuit::add_edge(const InputOutput::InputEdge& input_edge) -> size_type
 {
-    Solution solution (number_of_edges_);
+    const auto edge_index = edge_places_.size();
+    const Edge edge (input_edge, static_cast<unsigned>(edge_index));
+    edge_places_.push_back(EdgePlace{});
+    ++number_of_edges_;
 
+    const auto itr1 = node_cirs_.find(input_edge.node1_);
+    const auto itr2 = node_cirs_.find(input_edge.node2_);
+    if (itr1 == node_cirs_.end() && itr2 == node_cirs_.end())
+    {
+        push_cir(ConnectedCircuit{edge}); // O(1)
+        number_of_nodes_ = node_cirs_.size();
+        return edge_index;
+    }
+
+    auto cir_index = (itr1 != node_cirs_.end()) ? itr1->second : itr2->second;
+    if (itr1 != node_cirs_.end() && itr2 != node_cirs_.end() && itr1->second != itr2->second)
+    {
+        // append smaller connected circuit to bigger one
+        auto small_index = itr2->second;
+        if (cirs_[cir_index].number_of_edges() < cirs_[small_index].number_of_edges())
+            std::swap(cir_index, small_index);
+
+        for (const auto& small_edge: cirs_[small_index].edges()) // ME iterations
+            append_edge(cir_index, small_edge);
+
+        erase_cir(small_index); // ME iterations
+        if (cir_index == cirs_.size())
+            cir_index = small_index; // bigger circuit was the last one and was moved on place of erased one
+    }
+
+    append_edge(cir_index, edge);
+    memo_.solutions_[cir_index].clear();
+    number_of_nodes_ = node_cirs_.size();
+    return edge_index;
+}
+
+// Complexity: O(MN * ME)
+void Circuit::remove_edge(size_type edge_index)
+{
+    if (edge_index >= edge_places_.size() || edge_places_[edge_index].removed_)
+        throw std::out_of_range{"there is no edge with such index in circuit"};
+
+    const auto cir_index = edge_places_[edge_index].cir_;
+    edge_places_[edge_index].removed_ = true;
+    --number_of_edges_;
+
+    Edges edges {};
+    for (const auto& edge: cirs_[cir_index].edges()) // ME iterations
+    {
+        node_cirs_.erase(edge.node1_);
+        node_cirs_.erase(edge.node2_);
+        if (edge.ind_ != edge_index)
+            edges.push_back(edge);
+    }
+
+    auto nodes = make_nodes(edges.cbegin(), edges.cend()); // ME iterations
+    bool replaced = false;
+    while (!nodes.empty()) // number of connected circuits removed edge splits into
+    {
+        const auto& connected_cir = make_connected_cir_as_nodes(nodes); // MN * ME iterations
+        auto cir = make_connected_cir(connected_cir.cbegin(), connected_cir.cend()); // MN * ME iterations
+        if (replaced)
+            push_cir(std::move(cir));
+        else
+            replace_cir(cir_index, std::move(cir));
+        replaced = true;
+    }
+    if (!replaced)
+        erase_cir(cir_index);
+
+    number_of_nodes_ = node_cirs_.size();
+}
+
+// Complexity: O(1)
+void Circuit::change_edge(size_type edge_index, double resistance, double emf)
+{
+    if (edge_index >= edge_places_.size() || edge_places_[edge_index].removed_)
+        throw std::out_of_range{"there is no edge with such index in circuit"};
+
+    const auto& place = edge_places_[edge_index];
+    cirs_[place.cir_].change_edge(place.pos_, resistance, emf);
+    memo_.solutions_[place.cir_].clear();
+}
+
+// Complexity: O((MN + ME)^3) for the first call with cir_index and options, O(1) for next ones
+auto Circuit::solved_currents(size_type cir_index, const SolverOptions& options) const -> const Currents&
+{
+    auto& solutions = memo_.solutions_[cir_index];
+    for (const auto& solved: solutions) // Memo::max_solutions iterations
+        if (same_solution(solved.options_, options))
+            return solved.currents_;
+
+    if (solutions.size() == Memo::max_solutions)
+    {
+        for (size_type i = 1; i < solutions.size(); ++i) // Memo::max_solutions iterations
+            solutions[i - 1] = std::move(solutions[i]);
+        solutions.pop_back();
+    }
+
+    const auto& cir = cirs_[cir_index];
+    auto currents = cir.solve_currents(cir.make_plan(options), options); // (MN + ME)^3 iterations
+    solutions.push_back(Memo::Solved{options, std::move(currents)});
+    return solutions.back().currents_;
+}
+
+// Complexity: O(1)
+auto Circuit::edge_place(size_type edge_index) const -> std::pair<size_type, size_type>
+{
+    if (edge_index >= edge_places_.size() || edge_places_[edge_index].removed_)
+        throw std::out_of_range{"there is no edge with such index in circuit"};
+    return {edge_places_[edge_index].cir_, edge_places_[edge_index].pos_};
+}
+
+// Complexity: O((MN + ME)^3) for the first query in connected circuit, O(1) for next ones
+std::optional<double> Circuit::current(size_type edge_index, const SolverOptions& options) const
+{
+    if (edge_index >= edge_places_.size() || edge_places_[edge_index].removed_)
+        throw std::out_of_range{"there is no edge with such index in circuit"};
+
+    const auto& place = edge_places_[edge_index];
+    std::lock_guard lock {memo_.mutex_};
+    const auto& currents = solved_currents(place.cir_, options);
+    if (currents.empty())
+        return std::nullopt;
+    return currents[place.pos_];
+}
+
+// Complexity: O(K + S * (MN + ME)^3)
+auto Circuit::currents(std::span<const size_type> edge_indexes, const SolverOptions& options) const -> Container::Vector<std::optional<double>>
+{
+    Container::Vector<std::optional<double>> result {};
+    result.reserve(edge_indexes.size());
+    for (auto edge_index: edge_indexes) // K iterations
+        result.push_back(current(edge_index, options));
+    return result;
+}
+
+// Complexity: O(N + E)
+auto Circuit::zero_resistance_loops() const -> Container::Vector<Edges>
+{
+    Container::Vector<Edges> loops {};
     for (const auto& cir: cirs_) // C iterations
     {
-        const auto& sub_solution = cir.solve_circuit(); // (MN + ME)^3 iterations
-        for (const auto& edge_cur: sub_solution) // ME iterations
-            solution[edge_cur.first.ind_] = edge_cur;
+        auto loop = cir.find_zero_resistance_loop(); // MN + ME iterations
+        if (!loop.empty())
+            loops.push_back(std::move(loop));
+    }
+    return loops;
+}
+
+// Complexity: O(С * (MN + ME)^3)
+// Solution is indexed by edge indexes, removed edges are EdgeCur{}
+auto Circuit::solve_circuit(const SolverOptions& options) const -> Solution
+{
+    Solution solution {};
+    solution.reserve(edge_places_.size());
+
+    std::lock_guard lock {memo_.mutex_};
+    for (const auto& place: edge_places_) // E iterations
+    {
+        if (place.removed_)
+        {
+            solution.push_back(EdgeCur{});
+            continue;
+        }
+
+        const auto& currents = solved_currents(place.cir_, options); // (MN + ME)^3 iterations once per connected circuit
+        const auto current = currents.empty() ? std::numeric_limits<double>::quiet_NaN() : currents[place.pos_];
+        solution.push_back(EdgeCur{cirs_[place.cir_].edges()[place.pos_], current});
     }
 
     return solution;
 }
-} // namespace Circuit
\ No newline at end of file
+
+// Complexity: O(N + E)
+Residuals Circuit::verify(const Solution& solution) const
+{
+    if (solution.size() != edge_places_.size())
+        throw std::invalid_argument{"solution doesn't match circuit"};
+
+    Edges edges {};
+    Currents currents {};
+    edges.reserve(number_of_edges_);
+    currents.reserve(number_of_edges_);
+    for (size_type i = 0; i < edge_places_.size(); ++i) // E iterations
+    {
+        const auto& place = edge_places_[i];
+        if (place.removed_)
+            continue;
+
+        const auto& edge = cirs_[place.cir_].edges()[place.pos_];
+        const auto& [solution_edge, current] = solution[i];
+        if (solution_edge.ind_ != edge.ind_ || solution_edge.node1_ != edge.node1_ || solution_edge.node2_ != edge.node2_)
+            throw std::invalid_argument{"solution doesn't match circuit"};
+        currents.push_back(current); // NaN for unsolved connected circuit
+        edges.push_back(edge);
+    }
+
+    return compute_residuals(edges, currents); // N + E iterations
+}
+} // namespace Circuit
@@ -0,0 +1,120 @@
+#include "circuit_pattern.hpp"
+#include "run_in_parallel.hpp"
+
+#include <atomic>
+#include <limits>
+#include <string>
+
+namespace Circuit
+{
+// Complexity: O(C * MN * ME + (N + E) * log(N + E))
+CircuitPattern::CircuitPattern(const Circuit& circuit, const SolverOptions& options)
+:options_ {options}
+{
+    components_.reserve(circuit.number_of_connected_circuits());
+    for (size_type i = 0; i < circuit.number_of_connected_circuits(); ++i) // C iterations
+    {
+        const auto& cir = circuit.connected_circuit(i);
+        auto plan = cir.make_plan(options_); // MN + ME * log(ME) iterations
+        components_.push_back(Component{cir, std::move(plan)});
+    }
+
+    edge_places_.reserve(circuit.number_of_edges());
+    signs_.reserve(circuit.number_of_edges());
+    for (size_type i = 0; i < circuit.number_of_edges(); ++i) // E iterations
+    {
+        const auto [cir, pos] = circuit.edge_place(i);
+        edge_places_.push_back(EdgePlace{cir, pos});
+        signs_.push_back(sign(components_[cir].cir_.edges()[pos].resistance_));
+    }
+
+    // solving may run in several threads
+    options_.log_ = nullptr;
+}
+
+// Complexity: O(E)
+auto CircuitPattern::values() const -> ValueSet
+{
+    ValueSet values {};
+    values.reserve(number_of_edges());
+    for (const auto& place: edge_places_) // E iterations
+    {
+        const auto& edge = components_[place.cir_].cir_.edges()[place.pos_];
+        values.push_back(Values{edge.resistance_, edge.emf_});
+    }
+    return values;
+}
+
+// Complexity: O(E)
+void CircuitPattern::check(const ValueSet& values) const
+{
+    if (values.size() != number_of_edges())
+        throw std::invalid_argument{"number of values doesn't match number of edges of circuit pattern"};
+    for (size_type i = 0; i < values.size(); ++i) // E iterations
+        if (sign(values[i].resistance_) != signs_[i])
+            throw std::invalid_argument{"resistance of edge " + std::to_string(i) + " changes sign of circuit pattern"};
+}
+
+// Complexity: O(E)
+auto CircuitPattern::copy_connected_circuits() const -> Container::Vector<ConnectedCircuit>
+{
+    Container::Vector<ConnectedCircuit> cirs {};
+    cirs.reserve(components_.size());
+    for (const auto& component: components_) // C iterations
+        cirs.push_back(component.cir_);
+    return cirs;
+}
+
+// Complexity: O(E) + numeric factorization and solve of every connected circuit
+auto CircuitPattern::solve(const ValueSet& values, Container::Vector<ConnectedCircuit>& cirs,
+                           const SolverOptions& options) const -> Currents
+{
+    for (size_type i = 0; i < values.size(); ++i) // E iterations
+        cirs[edge_places_[i].cir_].change_edge(edge_places_[i].pos_, values[i].resistance_, values[i].emf_);
+
+    Currents currents (number_of_edges());
+    for (size_type i = 0; i < cirs.size(); ++i) // C iterations
+    {
+        const auto& sub_currents = cirs[i].solve_currents(components_[i].plan_, options);
+        const auto& edges = cirs[i].edges();
+        for (size_type pos = 0; pos < edges.size(); ++pos) // ME iterations
+            currents[edges[pos].ind_] = sub_currents.empty() ? std::numeric_limits<double>::quiet_NaN() : sub_currents[pos];
+    }
+    return currents;
+}
+
+// Complexity: O(E) + numeric factorization and solve of every connected circuit
+auto CircuitPattern::solve(const ValueSet& values) const -> Currents
+{
+    check(values); // E iterations
+    auto cirs = copy_connected_circuits(); // E iterations
+    return solve(values, cirs, options_);
+}
+
+// Complexity: O(S * (E + numeric factorization and solve of every connected circuit))
+auto CircuitPattern::solve_batch(const Container::Vector<ValueSet>& value_sets) const -> Container::Vector<Currents>
+{
+    for (const auto& values: value_sets) // S * E iterations
+        check(values);
+
+    Container::Vector<Currents> results (value_sets.size());
+    if (value_sets.empty())
+        return results;
+
+    // one budget of threads is divided between value sets and schur solver of every value set
+    const auto budget = (options_.number_of_threads_ != 0) ? options_.number_of_threads_
+                                                           : std::max(1u, std::thread::hardware_concurrency());
+    const auto number_of_threads = std::min<size_type>(value_sets.size(), budget);
+    auto sample_options = options_;
+    sample_options.number_of_threads_ = std::max<size_type>(budget / number_of_threads, 1);
+
+    std::atomic<size_type> next {0};
+    run_in_parallel(number_of_threads, [&](size_type)
+    {
+        auto cirs = copy_connected_circuits(); // E iterations
+        for (auto i = next.fetch_add(1); i < value_sets.size(); i = next.fetch_add(1))
+            results[i] = solve(value_sets[i], cirs, sample_options);
+    });
+    return results;
+}
+} // namespace Circuit
@@ -6,22 +6,31 @@ namespace Circuit
 auto ConnectedCircuit::make_slae() const -> MatrixSLAE
 {
     MatrixSLAE slae (number_of_edges() + number_of_nodes()); // (N + E)^2 iterations
-    add_first_Kirchhof_rule_equations(slae);                 // N * E iterations
-    add_potential_difference_equations(slae);                // N * E iterations
+    add_first_Kirchhof_rule_equations(slae);                 // E iterations
+    add_potential_difference_equations(slae);                // E iterations
     return slae;
 }
 
-// Cоmplexity: O(N * E)
+// Cоmplexity: O(E)
 void ConnectedCircuit::add_first_Kirchhof_rule_equations(MatrixSLAE& slae) const
 {
-    for (size_type i = 0; i < number_of_nodes() - 1; ++i) // N iterations
-        std::copy(incidence_matrix_[i].cbegin(), incidence_matrix_[i].cend(), slae[i].begin()); // E iterations
+    const auto last_node = number_of_nodes() - 1; // equation of the last node follows from the others
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        const auto& edge = edges_[i];
+        if (edge.node1_ == edge.node2_) // current of loop edge flows in and out of the same node
+            continue;
+        if (index(edge.node1_) != last_node)
+            slae[index(edge.node1_)][i] = flow_out;
+        if (index(edge.node2_) != last_node)
+            slae[index(edge.node2_)][i] = flow_in;
+    }
 }
 
-// Complexity: O(N * E)
+// Complexity: O(E)
 void ConnectedCircuit::add_potential_difference_equations(MatrixSLAE& slae) const
 {
-    slae[number_of_nodes() - 1][number_of_edges()] = 1.0; // equation phi0 == 0, N * E iterations
+    slae[number_of_nodes() - 1][number_of_edges()] = 1.0; // equation phi0 == 0
     for (size_type i = 0; i < number_of_edges(); ++i) // N iterations
     {
         auto& row = slae[number_of_nodes() + i];
@@ -29,23 +38,309 @@ void ConnectedCircuit::add_potential_difference_equations(MatrixSLAE& slae) cons
 
         row[i]     = edge.resistance_;
         row.back() = edge.emf_;
+        if (edge.node1_ == edge.node2_) // potentials of loop edge nodes are the same
+            continue;
         row[number_of_edges() + index(edge.node1_)] = -1.0;
         row[number_of_edges() + index(edge.node2_)] = 1.0;
     }
 }
 
+// Complexity: O(N + E)
+auto ConnectedCircuit::find_zero_resistance_loop() const -> Edges
+{
+    // disjoint sets of nodes connected by zero-resistance edges
+    Container::Vector<size_type> parents (number_of_nodes());
+    for (size_type i = 0; i < parents.size(); ++i) // N iterations
+        parents[i] = i;
+
+    auto find = [&parents](size_type node)
+    {
+        while (parents[node] != node)
+            node = parents[node] = parents[parents[node]];
+        return node;
+    };
+
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        const auto& edge = edges_[i];
+        if (edge.resistance_ != 0.0)
+            continue;
+
+        const auto root1 = find(index(edge.node1_));
+        const auto root2 = find(index(edge.node2_));
+        if (root1 != root2)
+        {
+            parents[root1] = root2;
+            continue;
+        }
+
+        // edge closes a loop: find path between its nodes in forest of previous zero-resistance edges
+        std::unordered_map<size_type, Container::Vector<size_type>> forest {};
+        for (size_type j = 0; j < i; ++j) // E iterations
+            if (edges_[j].resistance_ == 0.0)
+            {
+                forest[index(edges_[j].node1_)].push_back(j);
+                forest[index(edges_[j].node2_)].push_back(j);
+            }
+
+        const auto start = index(edge.node1_);
+        const auto finish = index(edge.node2_);
+        std::unordered_map<size_type, size_type> came_by {{start, i}};
+        Container::Vector<size_type> queue {start};
+        for (size_type k = 0; k < queue.size() && !came_by.contains(finish); ++k) // N iterations
+            for (auto j: forest[queue[k]])
+            {
+                const auto next = (index(edges_[j].node1_) == queue[k]) ? index(edges_[j].node2_) : index(edges_[j].node1_);
+                if (came_by.insert({next, j}).second)
+                    queue.push_back(next);
+            }
+
+        Edges loop {edge};
+        for (auto node = finish; node != start;) // N iterations
+        {
+            const auto& path_edge = edges_[came_by[node]];
+            loop.push_back(path_edge);
+            node = (index(path_edge.node1_) == node) ? index(path_edge.node2_) : index(path_edge.node1_);
+        }
+        return loop;
+    }
+
+    return Edges{};
+}
+
 // Complexity: O((N + E)^3)
-auto ConnectedCircuit::solve_circuit() const -> Solution
+auto ConnectedCircuit::solve_dense() const -> Currents
 {
+    Stats::Timer assembly {Stats::Phase::assembly};
     const auto& slae = make_slae();    // (N + E)^2 iterations
-    const auto& currents = slae.solve_slae(); // (N + E)^3 iterations
-    if (currents.size() == 0)
-        return Solution{};
+    assembly.stop();
 
+    Stats::Timer elimination {Stats::Phase::elimination};
+    size_type number_of_pivots = 0;
+    const auto& solution = slae.solve_slae(&number_of_pivots); // (N + E)^3 iterations
+    Stats::count(Stats::Counter::pivots, number_of_pivots);
+    if (solution.size() == 0)
+        return Currents{};
+
+    Currents currents {};
+    currents.reserve(number_of_edges());
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+        currents.push_back(solution[i]);
+    return currents;
+}
+
+// Complexity: depends on solver, see NodalSLAE
+auto ConnectedCircuit::solve_nodal(const NodalSLAE& nodal, Solver solver, const SolverOptions& options) const -> Currents
+{
+    Stats::Timer assembly {Stats::Phase::assembly};
+    const auto& offsets = nodal.make_offsets(edges_);
+    const auto& matrix  = nodal.make_matrix(edges_, offsets);
+    assembly.stop();
+
+    Stats::Timer elimination {Stats::Phase::elimination};
+    const auto& potentials = (solver == Solver::envelope) ? nodal.solve_envelope(matrix)
+                           : (solver == Solver::schur)    ? nodal.solve_schur(matrix, number_of_threads(options))
+                                                          : nodal.solve_conjugate_gradient(matrix, options.tolerance_);
+    if (potentials.size() != nodal.number_of_rows())
+        return Currents{};
+    return nodal.make_currents(edges_, offsets, potentials);
+}
+
+// Complexity: O(E)
+bool ConnectedCircuit::has_negative_resistance() const
+{
+    return std::any_of(edges_.cbegin(), edges_.cend(), [](const Edge& edge){return !(edge.resistance_ >= 0.0);});
+}
+
+// Complexity: O(E)
+auto ConnectedCircuit::make_solution(const Currents& currents) const -> Solution
+{
     Solution solution {};
     solution.reserve(number_of_edges());
     for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
         solution.push_back(std::pair<Edge, double>(edges_[i], currents[i]));
     return solution;
 }
-} // namespace Circuit
\ No newline at end of file
+
+// Complexity: O(1)
+auto ConnectedCircuit::number_of_threads(const SolverOptions& options) -> size_type
+{
+    if (options.number_of_threads_ != 0)
+        return options.number_of_threads_;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Complexity: O(1), O(number of parts of nested dissection) for schur solver
+SolverCost ConnectedCircuit::estimate_cost(Solver solver, const NodalSLAE* nodal, size_type number_of_domains) const
+{
+    constexpr auto dbl = sizeof(double);
+    constexpr auto ind = sizeof(size_type);
+
+    if (solver == Solver::dense)
+    {
+        // slae and its copy eliminated in MatrixSLAE::solve_slae()
+        const auto size = static_cast<double>(number_of_nodes() + number_of_edges());
+        const auto memory = 2 * dbl * (number_of_nodes() + number_of_edges()) * (number_of_nodes() + number_of_edges() + 1);
+        return SolverCost{solver, 2.0 / 3.0 * size * size * size, memory};
+    }
+
+    if (nodal == nullptr)
+        throw std::invalid_argument{"nodal slae is needed to estimate nodal solvers"};
+
+    const auto rows = nodal->number_of_rows();
+    const auto nonzeros = nodal->number_of_nonzeros();
+    // symbolic analysis (with nested dissection and structure of its factor), matrix and recovery of currents
+    // are the same for nodal solvers
+    const auto common_memory = ind * (4 * nodal->number_of_nodes() + 5 * nodal->number_of_edges() + 11 * rows + nonzeros)
+                             + dbl * (2 * nodal->number_of_nodes() + 4 * rows + nonzeros + nodal->number_of_edges());
+    const auto common_flops = 10.0 * static_cast<double>(nodal->number_of_nodes() + nodal->number_of_edges());
+
+    if (solver == Solver::envelope)
+        return SolverCost{solver, common_flops + nodal->envelope_flops() + 4.0 * static_cast<double>(nodal->envelope_size()),
+                          common_memory + dbl * nodal->envelope_size()};
+
+    if (solver == Solver::schur)
+    {
+        // Time is estimated, not the whole work: subdomains of nested dissection and then separators of the same level
+        // are eliminated in number_of_domains threads, sparse factor is applied in one thread
+        const auto factor = nodal->factor_size();
+        return SolverCost{solver, common_flops + nodal->dissection_flops(number_of_domains) + 4.0 * static_cast<double>(factor),
+                          common_memory + dbl * (factor + rows) + ind * (factor + 2 * rows + number_of_domains * rows)};
+    }
+
+    // Condition number of conductance matrix grows with square of graph diameter,
+    // so number of iterations is estimated as linear in number of BFS levels
+    const auto iterations = static_cast<double>(std::min(2 * rows + 10, 8 * nodal->number_of_levels() + 20));
+    return SolverCost{Solver::conjugate_gradient, common_flops + iterations * (2.0 * static_cast<double>(nonzeros + 6 * rows)),
+                      common_memory + 4 * dbl * rows};
+}
+
+// Complexity: O(N + E)
+auto ConnectedCircuit::choose_solvers(const SolverOptions& options, const NodalSLAE* nodal) const -> Container::Vector<SolverCost>
+{
+    Container::Vector<SolverCost> costs {estimate_cost(Solver::dense)};
+    if (nodal != nullptr)
+    {
+        costs.push_back(estimate_cost(Solver::envelope, nodal));
+        costs.push_back(estimate_cost(Solver::conjugate_gradient, nodal));
+        costs.push_back(estimate_cost(Solver::schur, nodal, number_of_threads(options)));
+    }
+    std::sort(costs.begin(), costs.end(), [](const auto& lhs, const auto& rhs){return lhs.flops_ < rhs.flops_;});
+
+    Container::Vector<SolverCost> chosen {};
+    for (const auto& cost: costs) // explicitly chosen solver
+        if (cost.solver_ == options.solver_)
+            chosen.push_back(cost);
+    if (options.solver_ != Solver::automatic && chosen.empty())
+        throw std::invalid_argument{"nodal solvers cannot solve circuits with negative resistances"};
+
+    for (const auto& cost: costs)
+        if (cost.solver_ != options.solver_ && cost.memory_ <= options.memory_budget_)
+            chosen.push_back(cost);
+    if (chosen.empty())
+    {
+        // circuit is solved anyway as it was before budget existed, with solver needing the least memory
+        chosen.push_back(*std::min_element(costs.cbegin(), costs.cend(),
+                                           [](const auto& lhs, const auto& rhs){return lhs.memory_ < rhs.memory_;}));
+        if (options.log_)
+            *options.log_ << "there is no solver fitting in memory budget of " << options.memory_budget_ << " bytes, "
+                          << solver_name(chosen.front().solver_) << " solver needs the least memory\n";
+    }
+
+    return chosen;
+}
+
+// Complexity: O((N + E) * log(N + E))
+auto ConnectedCircuit::make_plan(const SolverOptions& options) const -> Plan
+{
+    Plan plan {};
+    if (!find_zero_resistance_loop().empty()) // N + E iterations
+    {
+        if (options.log_)
+            *options.log_ << "connected circuit with " << number_of_nodes() << " nodes and " << number_of_edges()
+                          << " edges has a loop of zero-resistance edges\n";
+        plan.singular_ = true;
+        return plan;
+    }
+
+    const auto tiny = (options.solver_ == Solver::automatic && number_of_nodes() + number_of_edges() <= tiny_size);
+    if (!tiny && !has_negative_resistance())
+    {
+        Stats::Timer analysis {Stats::Phase::analysis};
+        plan.nodal_.emplace(edges_); // (N + E) * log(N + E) iterations
+    }
+    plan.solvers_ = tiny ? Container::Vector<SolverCost>{estimate_cost(Solver::dense)}
+                         : choose_solvers(options, plan.nodal_ ? &*plan.nodal_ : nullptr);
+    return plan;
+}
+
+// Complexity: O((N + E)^3) for dense solver, see NodalSLAE for the others
+auto ConnectedCircuit::solve_currents(const Plan& plan, const SolverOptions& options) const -> Currents
+{
+    Stats::ComponentScope stats {number_of_nodes(), number_of_edges()}; // unsolved ones are recorded too
+    if (plan.singular_)
+        return Currents{};
+
+    // After solution failed verification only more robust solvers are tried
+    auto min_robustness = robustness(Solver::conjugate_gradient);
+    Currents best {};
+    auto best_residual = std::numeric_limits<double>::infinity();
+    for (const auto& cost: plan.solvers_)
+    {
+        if (robustness(cost.solver_) < min_robustness)
+            continue;
+        if (options.log_)
+            *options.log_ << "connected circuit with " << number_of_nodes() << " nodes and " << number_of_edges()
+                          << " edges: " << solver_name(cost.solver_) << " solver, estimated " << cost.flops_
+                          << " flops, " << cost.memory_ << " bytes\n";
+
+        auto currents = (cost.solver_ == Solver::dense) ? solve_dense()
+                                                        : solve_nodal(*plan.nodal_, cost.solver_, options);
+        if (currents.empty() && number_of_edges() != 0)
+        {
+            if (cost.solver_ == Solver::dense) // dense solver fails only on singular slae
+                break;
+            Stats::count(Stats::Counter::solver_failures);
+            if (options.log_)
+                *options.log_ << solver_name(cost.solver_) << " solver failed\n";
+            continue;
+        }
+
+        if (options.verification_tolerance_ > 0.0)
+        {
+            auto residual = verify(currents).max(); // N + E iterations
+            // infinite current makes residual NaN, NaN current would be skipped as unsolved edge
+            if (std::isnan(residual) || !std::all_of(currents.cbegin(), currents.cend(), [](double cur){return std::isfinite(cur);}))
+                residual = std::numeric_limits<double>::infinity();
+            if (residual > options.verification_tolerance_)
+            {
+                Stats::count(Stats::Counter::verification_failures);
+                if (options.log_)
+                    *options.log_ << solver_name(cost.solver_) << " solver failed verification: residual " << residual << "\n";
+                if (residual < best_residual)
+                {
+                    best = std::move(currents);
+                    best_residual = residual;
+                    stats.set_solver(cost.solver_);
+                }
+                min_robustness = robustness(cost.solver_) + 1;
+                continue;
+            }
+        }
+
+        stats.set_solver(cost.solver_);
+        return currents;
+    }
+
+    return best;
+}
+
+// Complexity: O((N + E)^3) for dense solver, see NodalSLAE for the others
+auto ConnectedCircuit::solve_circuit(const SolverOptions& options) const -> Solution
+{
+    const auto& currents = solve_currents(make_plan(options), options);
+    if (currents.empty())
+        return Solution{};
+    return make_solution(currents);
+}
+} // namespace Circuit
@@ -0,0 +1,854 @@
+#include "nodal_slae.hpp"
+#include "run_in_parallel.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+namespace Circuit
+{
+// Complexity: O((N + E) * log(N + E))
+NodalSLAE::NodalSLAE(const Edges& edges)
+{
+    std::unordered_map<unsigned, size_type> nodes_to_indexis {};
+    edge_nodes_.reserve(edges.size());
+    zero_resistance_.reserve(edges.size());
+    for (const auto& edge: edges) // E iterations
+    {
+        const auto node1 = nodes_to_indexis.insert({edge.node1_, nodes_to_indexis.size()}).first->second;
+        const auto node2 = nodes_to_indexis.insert({edge.node2_, nodes_to_indexis.size()}).first->second;
+        edge_nodes_.push_back(EdgeNodes{node1, node2});
+        zero_resistance_.push_back(edge.resistance_ == 0.0);
+    }
+    number_of_nodes_ = nodes_to_indexis.size();
+
+    make_supernodes();       // N + E iterations
+    make_rows();             // N + E * log(E) iterations
+    make_envelope();         // M + Z iterations
+    make_dissection();       // (M + Z) * log(M) iterations
+    make_factor_structure(); // M + Z * α(M) iterations
+}
+
+// Complexity: O(N + E)
+void NodalSLAE::make_supernodes()
+{
+    // zero-resistance edges of node I are zero_edges[zero_starts[I]...zero_starts[I + 1]]
+    Container::Vector<size_type> zero_starts (number_of_nodes_ + 1);
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+        if (zero_resistance_[i])
+        {
+            ++zero_starts[edge_nodes_[i].node1_ + 1];
+            ++zero_starts[edge_nodes_[i].node2_ + 1];
+        }
+    for (size_type i = 0; i < number_of_nodes_; ++i) // N iterations
+        zero_starts[i + 1] += zero_starts[i];
+
+    Container::Vector<size_type> zero_edges (zero_starts[number_of_nodes_]);
+    auto filled = zero_starts;
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+        if (zero_resistance_[i])
+        {
+            zero_edges[filled[edge_nodes_[i].node1_]++] = i;
+            zero_edges[filled[edge_nodes_[i].node2_]++] = i;
+        }
+
+    // supernodes are numbered in order of their roots, so node 0 is in supernode 0 (ground)
+    tree_parents_ = Container::Vector<size_type>(number_of_nodes_);
+    rows_         = Container::Vector<size_type>(number_of_nodes_);
+    Container::Vector<bool> visited (number_of_nodes_);
+    tree_order_.reserve(number_of_nodes_);
+    size_type number_of_supernodes = 0;
+    for (size_type root = 0; root < number_of_nodes_; ++root) // N iterations
+    {
+        if (visited[root])
+            continue;
+
+        visited[root] = true;
+        tree_parents_[root] = npos;
+        tree_order_.push_back(root);
+        for (auto k = tree_order_.size() - 1; k < tree_order_.size(); ++k) // nodes of supernode
+        {
+            const auto node = tree_order_[k];
+            rows_[node] = number_of_supernodes; // rows are made from supernodes in make_rows()
+            for (auto j = zero_starts[node]; j < zero_starts[node + 1]; ++j)
+            {
+                const auto edge = zero_edges[j];
+                const auto next = (edge_nodes_[edge].node1_ == node) ? edge_nodes_[edge].node2_ : edge_nodes_[edge].node1_;
+                if (visited[next])
+                    continue;
+                visited[next] = true;
+                tree_parents_[next] = edge;
+                tree_order_.push_back(next);
+            }
+        }
+        ++number_of_supernodes;
+    }
+    number_of_rows_ = number_of_supernodes - 1;
+}
+
+// Complexity: O(N + E * log(E))
+void NodalSLAE::make_rows()
+{
+    const auto number_of_supernodes = number_of_rows_ + 1;
+
+    // neighbours of supernode I are neighbours[starts[I]...starts[I + 1]]
+    Container::Vector<size_type> starts (number_of_supernodes + 1);
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        const auto supernode1 = rows_[edge_nodes_[i].node1_];
+        const auto supernode2 = rows_[edge_nodes_[i].node2_];
+        if (zero_resistance_[i] || supernode1 == supernode2)
+            continue;
+        ++starts[supernode1 + 1];
+        ++starts[supernode2 + 1];
+    }
+    for (size_type i = 0; i < number_of_supernodes; ++i) // N iterations
+        starts[i + 1] += starts[i];
+
+    Container::Vector<size_type> neighbours (starts[number_of_supernodes]);
+    auto filled = starts;
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        const auto supernode1 = rows_[edge_nodes_[i].node1_];
+        const auto supernode2 = rows_[edge_nodes_[i].node2_];
+        if (zero_resistance_[i] || supernode1 == supernode2)
+            continue;
+        neighbours[filled[supernode1]++] = supernode2;
+        neighbours[filled[supernode2]++] = supernode1;
+    }
+
+    // remove multi-edges and ground, degrees[I] - number of neighbours of supernode I
+    Container::Vector<size_type> degrees (number_of_supernodes);
+    for (size_type i = 0; i < number_of_supernodes; ++i) // N iterations
+    {
+        const auto first = neighbours.begin() + starts[i];
+        const auto last  = neighbours.begin() + starts[i + 1];
+        std::sort(first, last); // E * log(E) iterations in total
+        const auto unique_last = std::unique(first, last);
+        degrees[i] = unique_last - first - ((first != unique_last && *first == 0) ? 1 : 0);
+        std::fill(unique_last, last, npos);
+    }
+
+    // Reverse Cuthill-McKee: BFS from supernodes of minimal degree, neighbours are visited in order of degree
+    Container::Vector<size_type> by_degree {};
+    by_degree.reserve(number_of_rows_);
+    for (size_type i = 1; i < number_of_supernodes; ++i) // N iterations
+        by_degree.push_back(i);
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&degrees](auto lhs, auto rhs){return degrees[lhs] < degrees[rhs];});
+
+    Container::Vector<size_type> order {};
+    order.reserve(number_of_rows_);
+    Container::Vector<bool> visited (number_of_supernodes);
+    visited[0] = true;
+    Container::Vector<size_type> next_level {};
+    for (auto start: by_degree) // N iterations
+    {
+        if (visited[start])
+            continue;
+
+        visited[start] = true;
+        order.push_back(start);
+        size_type levels = 1, level_end = order.size();
+        for (auto k = order.size() - 1; k < order.size(); ++k) // nodes of connected part of graph without ground
+        {
+            if (k == level_end)
+            {
+                ++levels;
+                level_end = order.size();
+            }
+
+            const auto supernode = order[k];
+            next_level.clear();
+            for (auto j = starts[supernode]; j < starts[supernode + 1] && neighbours[j] != npos; ++j)
+                if (!visited[neighbours[j]])
+                {
+                    visited[neighbours[j]] = true;
+                    next_level.push_back(neighbours[j]);
+                }
+            std::stable_sort(next_level.begin(), next_level.end(), [&degrees](auto lhs, auto rhs){return degrees[lhs] < degrees[rhs];});
+            for (auto next: next_level)
+                order.push_back(next);
+        }
+        number_of_levels_ = std::max(number_of_levels_, levels);
+    }
+
+    Container::Vector<size_type> supernode_rows (number_of_supernodes);
+    supernode_rows[0] = npos;
+    for (size_type i = 0; i < order.size(); ++i) // N iterations
+        supernode_rows[order[i]] = number_of_rows_ - 1 - i;
+    for (auto& row: rows_) // N iterations
+        row = supernode_rows[row];
+
+    row_starts_ = Container::Vector<size_type>(number_of_rows_ + 1);
+    for (size_type i = 1; i < number_of_supernodes; ++i) // N iterations
+        row_starts_[supernode_rows[i] + 1] = degrees[i];
+    for (size_type i = 0; i < number_of_rows_; ++i) // N iterations
+        row_starts_[i + 1] += row_starts_[i];
+
+    cols_ = Container::Vector<size_type>(row_starts_[number_of_rows_]);
+    for (size_type i = 1; i < number_of_supernodes; ++i) // E iterations in total
+    {
+        const auto row = supernode_rows[i];
+        auto pos = row_starts_[row];
+        for (auto j = starts[i]; j < starts[i + 1] && neighbours[j] != npos; ++j)
+            if (neighbours[j] != 0)
+                cols_[pos++] = supernode_rows[neighbours[j]];
+        std::sort(cols_.begin() + row_starts_[row], cols_.begin() + pos);
+    }
+
+    edge_positions_ = Container::Vector<EdgePositions>(number_of_edges());
+    auto position = [this](size_type row, size_type col)
+    {
+        return std::lower_bound(cols_.begin() + row_starts_[row], cols_.begin() + row_starts_[row + 1], col) - cols_.begin();
+    };
+    for (size_type i = 0; i < number_of_edges(); ++i) // E * log(E) iterations
+    {
+        const auto row1 = rows_[edge_nodes_[i].node1_];
+        const auto row2 = rows_[edge_nodes_[i].node2_];
+        if (zero_resistance_[i] || row1 == row2 || row1 == npos || row2 == npos)
+            continue;
+        edge_positions_[i] = EdgePositions{static_cast<size_type>(position(row1, row2)), static_cast<size_type>(position(row2, row1))};
+    }
+}
+
+// Complexity: O(M + Z)
+void NodalSLAE::make_envelope()
+{
+    first_cols_ = Container::Vector<size_type>(number_of_rows_);
+    env_starts_ = Container::Vector<size_type>(number_of_rows_ + 1);
+    for (size_type i = 0; i < number_of_rows_; ++i) // M iterations
+    {
+        const auto first_col = (row_starts_[i] != row_starts_[i + 1]) ? std::min(i, cols_[row_starts_[i]]) : i;
+        const auto width = i - first_col;
+        first_cols_[i] = first_col;
+        env_starts_[i + 1] = env_starts_[i] + width + 1;
+        envelope_flops_ += static_cast<double>(width) * static_cast<double>(width + 1);
+    }
+}
+
+// Complexity: O(N + E)
+auto NodalSLAE::make_offsets(const Edges& edges) const -> Container::Vector<double>
+{
+    // potential of node is potential of its supernode plus offset
+    Container::Vector<double> offsets (number_of_nodes_);
+    for (auto node: tree_order_) // N iterations
+    {
+        const auto edge = tree_parents_[node];
+        if (edge == npos)
+            continue;
+
+        const auto& nodes = edge_nodes_[edge];
+        if (nodes.node2_ == node)
+            offsets[node] = offsets[nodes.node1_] + edges[edge].emf_; // phi2 - phi1 == emf
+        else
+            offsets[node] = offsets[nodes.node2_] - edges[edge].emf_;
+    }
+    return offsets;
+}
+
+// Complexity: O(M + E)
+auto NodalSLAE::make_matrix(const Edges& edges, const Container::Vector<double>& offsets) const -> NodalMatrix
+{
+    NodalMatrix matrix {Container::Vector<double>(number_of_rows_), Container::Vector<double>(cols_.size()),
+                        Container::Vector<double>(number_of_rows_)};
+
+    // current of edge I = (emf + phi1 - phi2) / R, sum of currents flowing in each supernode is 0
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        const auto& nodes = edge_nodes_[i];
+        const auto row1 = rows_[nodes.node1_];
+        const auto row2 = rows_[nodes.node2_];
+        if (zero_resistance_[i] || row1 == row2)
+            continue;
+
+        const auto conductance = 1.0 / edges[i].resistance_;
+        const auto source = conductance * (edges[i].emf_ + offsets[nodes.node1_] - offsets[nodes.node2_]);
+        if (row1 != npos)
+        {
+            matrix.diag_[row1] += conductance;
+            matrix.rhs_[row1]  -= source;
+        }
+        if (row2 != npos)
+        {
+            matrix.diag_[row2] += conductance;
+            matrix.rhs_[row2]  += source;
+        }
+        const auto& positions = edge_positions_[i];
+        if (positions.pos12_ != npos)
+        {
+            matrix.values_[positions.pos12_] -= conductance;
+            matrix.values_[positions.pos21_] -= conductance;
+        }
+    }
+
+    return matrix;
+}
+
+// Complexity: O(sum of squared row widths)
+bool NodalSLAE::factorize_envelope(const Container::Vector<size_type>& first_cols, const Container::Vector<size_type>& starts,
+                                   Container::Vector<double>& envelope)
+{
+    // element (I, J) is envelope[starts[I] + J - first_cols[I]]
+    for (size_type i = 0; i < first_cols.size(); ++i) // number of rows iterations
+    {
+        const auto row_i = starts[i] - first_cols[i];
+        for (auto j = first_cols[i]; j < i; ++j) // width of row I iterations
+        {
+            const auto row_j = starts[j] - first_cols[j];
+            auto sum = envelope[row_i + j];
+            for (auto k = std::max(first_cols[i], first_cols[j]); k < j; ++k)
+                sum -= envelope[row_i + k] * envelope[row_j + k];
+            envelope[row_i + j] = sum / envelope[row_j + j];
+        }
+
+        const auto original = envelope[row_i + i];
+        auto diag = original;
+        for (auto k = first_cols[i]; k < i; ++k)
+            diag -= envelope[row_i + k] * envelope[row_i + k];
+        if (!(diag > original * 1e-14))
+            return false;
+        envelope[row_i + i] = std::sqrt(diag);
+    }
+    return true;
+}
+
+// Complexity: O(size of envelope)
+void NodalSLAE::solve_factorized(const Container::Vector<size_type>& first_cols, const Container::Vector<size_type>& starts,
+                                 const Container::Vector<double>& envelope, Container::Vector<double>& rhs)
+{
+    const auto size = first_cols.size();
+    for (size_type i = 0; i < size; ++i) // L * y == rhs
+    {
+        const auto row_i = starts[i] - first_cols[i];
+        for (auto k = first_cols[i]; k < i; ++k)
+            rhs[i] -= envelope[row_i + k] * rhs[k];
+        rhs[i] /= envelope[row_i + i];
+    }
+    for (auto i = size; i-- > 0;) // L^T * x == y
+    {
+        const auto row_i = starts[i] - first_cols[i];
+        rhs[i] /= envelope[row_i + i];
+        for (auto k = first_cols[i]; k < i; ++k)
+            rhs[k] -= envelope[row_i + k] * rhs[i];
+    }
+}
+
+// Complexity: O(M + W + sum of squared row widths)
+auto NodalSLAE::solve_envelope(const NodalMatrix& matrix) const -> Container::Vector<double>
+{
+    // lower triangle of L: matrix == L * L^T
+    Container::Vector<double> envelope (envelope_size());
+    for (size_type i = 0; i < number_of_rows_; ++i) // M + Z iterations
+    {
+        envelope[env_starts_[i + 1] - 1] = matrix.diag_[i];
+        for (auto j = row_starts_[i]; j < row_starts_[i + 1] && cols_[j] < i; ++j)
+            envelope[env_starts_[i] + cols_[j] - first_cols_[i]] = matrix.values_[j];
+    }
+
+    if (!factorize_envelope(first_cols_, env_starts_, envelope)) // sum of squared row widths iterations
+        return Container::Vector<double>{};
+
+    auto potentials = matrix.rhs_;
+    solve_factorized(first_cols_, env_starts_, envelope, potentials); // W iterations
+    return potentials;
+}
+
+// Complexity: O((M + Z) * log(M))
+void NodalSLAE::make_dissection()
+{
+    dissection_rows_.reserve(number_of_rows_);
+    Container::Vector<size_type> rows {};
+    rows.reserve(number_of_rows_);
+    for (size_type i = 0; i < number_of_rows_; ++i) // M iterations
+        rows.push_back(i);
+
+    Container::Vector<size_type> stamps (number_of_rows_);
+    Container::Vector<size_type> levels (number_of_rows_);
+    std::fill(stamps.begin(), stamps.end(), npos);
+    if (number_of_rows_ != 0)
+        dissect(std::move(rows), 0, stamps, levels); // (M + Z) * log(M) iterations
+
+    dissection_positions_ = Container::Vector<size_type>(number_of_rows_);
+    for (size_type k = 0; k < number_of_rows_; ++k) // M iterations
+        dissection_positions_[dissection_rows_[k]] = k;
+}
+
+// Complexity: O((R + Z_R) * log(R))
+void NodalSLAE::dissect(Container::Vector<size_type>&& rows, size_type depth,
+                        Container::Vector<size_type>& stamps, Container::Vector<size_type>& levels)
+{
+    const auto part = parts_.size();
+    const auto begin = dissection_rows_.size();
+    parts_.push_back(Part{begin, begin, begin, depth});
+
+    // rows of leaf or separator are eliminated in order of envelope, so they keep its narrow band
+    auto append = [this](Container::Vector<size_type>& group)
+    {
+        std::sort(group.begin(), group.end());
+        for (auto row: group)
+            dissection_rows_.push_back(row);
+    };
+    auto make_leaf = [&]
+    {
+        append(rows);
+        parts_[part].end_ = dissection_rows_.size();
+    };
+
+    if (rows.size() <= dissection_leaf_size)
+        return make_leaf();
+
+    // BFS among rows from start over rows with levels == npos, order holds visited rows in order of levels
+    for (auto row: rows) // R iterations
+        stamps[row] = part;
+    auto reset_levels = [&]
+    {
+        for (auto row: rows) // R iterations
+            levels[row] = npos;
+    };
+    Container::Vector<size_type> order {};
+    auto bfs = [&](size_type start)
+    {
+        order.clear();
+        order.push_back(start);
+        levels[start] = 0;
+        for (size_type k = 0; k < order.size(); ++k) // R + Z_R iterations
+            for (auto j = row_starts_[order[k]]; j < row_starts_[order[k] + 1]; ++j)
+                if (stamps[cols_[j]] == part && levels[cols_[j]] == npos)
+                {
+                    levels[cols_[j]] = levels[order[k]] + 1;
+                    order.push_back(cols_[j]);
+                }
+    };
+
+    reset_levels();
+    bfs(rows.front());
+    if (order.size() != rows.size())
+    {
+        // connected parts of rows are independent subparts, separator is empty
+        Container::Vector<Container::Vector<size_type>> components {order};
+        for (auto row: rows) // R + Z_R iterations
+            if (levels[row] == npos)
+            {
+                bfs(row);
+                components.push_back(order);
+            }
+        for (auto& component: components)
+            dissect(std::move(component), depth + 1, stamps, levels);
+        parts_[part].separator_ = parts_[part].end_ = dissection_rows_.size();
+        return;
+    }
+
+    reset_levels();
+    bfs(order.back()); // the last row of BFS is pseudo-peripheral one, its levels are many and narrow
+    const auto number_of_levels = levels[order.back()] + 1;
+    if (number_of_levels < 3)
+        return make_leaf();
+
+    // middle level splits rows in halves, so depth of dissection is O(log(M))
+    const auto middle = std::clamp(levels[order[order.size() / 2]], size_type{1}, number_of_levels - 2);
+    Container::Vector<size_type> lower {}, upper {}, separator {};
+    for (auto row: order) // R iterations
+    {
+        if (levels[row] < middle)
+            lower.push_back(row);
+        else if (levels[row] > middle)
+            upper.push_back(row);
+        else
+            separator.push_back(row);
+    }
+
+    dissect(std::move(lower), depth + 1, stamps, levels);
+    dissect(std::move(upper), depth + 1, stamps, levels);
+    parts_[part].separator_ = dissection_rows_.size();
+    append(separator);
+    parts_[part].end_ = dissection_rows_.size();
+}
+
+// Complexity: O(M + Z * α(M))
+void NodalSLAE::make_factor_structure()
+{
+    const auto size = number_of_rows_;
+    auto for_each_neighbour = [this](size_type k, auto func) // neighbours of K-th row as positions
+    {
+        const auto row = dissection_rows_[k];
+        for (auto j = row_starts_[row]; j < row_starts_[row + 1]; ++j)
+            func(dissection_positions_[cols_[j]]);
+    };
+
+    // elimination tree, ancestors[I] - the highest known ancestor of I
+    etree_parents_ = Container::Vector<size_type>(size);
+    Container::Vector<size_type> ancestors (size);
+    for (size_type k = 0; k < size; ++k) // Z * α(M) iterations
+    {
+        etree_parents_[k] = ancestors[k] = npos;
+        for_each_neighbour(k, [&](size_type i)
+        {
+            while (i != npos && i < k)
+            {
+                const auto next = ancestors[i];
+                ancestors[i] = k;
+                if (next == npos)
+                    etree_parents_[i] = k;
+                i = next;
+            }
+        });
+    }
+
+    // postorder of elimination tree
+    Container::Vector<size_type> heads (size);
+    Container::Vector<size_type> nexts (size);
+    std::fill(heads.begin(), heads.end(), npos);
+    for (auto j = size; j-- > 0;) // M iterations
+        if (etree_parents_[j] != npos)
+        {
+            nexts[j] = heads[etree_parents_[j]];
+            heads[etree_parents_[j]] = j;
+        }
+    Container::Vector<size_type> postorder {};
+    postorder.reserve(size);
+    Container::Vector<size_type> stack {};
+    for (size_type root = 0; root < size; ++root) // M iterations
+    {
+        if (etree_parents_[root] != npos)
+            continue;
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            const auto node = stack.back();
+            const auto child = heads[node];
+            if (child == npos)
+            {
+                stack.pop_back();
+                postorder.push_back(node);
+                continue;
+            }
+            heads[node] = nexts[child];
+            stack.push_back(child);
+        }
+    }
+
+    // column counts: deltas of leaves of row subtrees summed up the tree
+    Container::Vector<std::ptrdiff_t> counts (size);
+    Container::Vector<size_type> firsts (size);      // first descendant in postorder
+    Container::Vector<size_type> max_firsts (size);  // the biggest firsts_ of leaves of row subtree met so far
+    Container::Vector<size_type> prev_leaves (size); // previous leaf of row subtree
+    std::fill(firsts.begin(), firsts.end(), npos);
+    std::fill(max_firsts.begin(), max_firsts.end(), npos);
+    std::fill(prev_leaves.begin(), prev_leaves.end(), npos);
+    for (size_type k = 0; k < size; ++k) // M iterations
+    {
+        auto j = postorder[k];
+        counts[j] = (firsts[j] == npos) ? 1 : 0; // leaf
+        for (; j != npos && firsts[j] == npos; j = etree_parents_[j])
+            firsts[j] = k;
+    }
+
+    for (size_type i = 0; i < size; ++i) // M iterations
+        ancestors[i] = i;
+    for (size_type k = 0; k < size; ++k) // Z * α(M) iterations
+    {
+        const auto j = postorder[k];
+        if (etree_parents_[j] != npos)
+            --counts[etree_parents_[j]];
+        for_each_neighbour(j, [&](size_type i)
+        {
+            // j is a leaf of row subtree of i if none of its descendants was met in row i
+            if (i <= j || (max_firsts[i] != npos && firsts[j] <= max_firsts[i]))
+                return;
+            max_firsts[i] = firsts[j];
+            const auto prev_leaf = prev_leaves[i];
+            prev_leaves[i] = j;
+            ++counts[j];
+            if (prev_leaf == npos)
+                return;
+
+            // least common ancestor of previous and this leaves is counted twice
+            auto lca = prev_leaf;
+            while (lca != ancestors[lca])
+                lca = ancestors[lca];
+            for (auto node = prev_leaf; node != lca;)
+            {
+                const auto next = ancestors[node];
+                ancestors[node] = lca;
+                node = next;
+            }
+            --counts[lca];
+        });
+        if (etree_parents_[j] != npos)
+            ancestors[j] = etree_parents_[j];
+    }
+    for (size_type j = 0; j < size; ++j) // M iterations, children are before parents
+        if (etree_parents_[j] != npos)
+            counts[etree_parents_[j]] += counts[j];
+
+    factor_starts_ = Container::Vector<size_type>(size + 1);
+    factor_flops_  = Container::Vector<double>(size + 1);
+    for (size_type j = 0; j < size; ++j) // M iterations
+    {
+        const auto count = static_cast<size_type>(counts[j]);
+        factor_starts_[j + 1] = factor_starts_[j] + count;
+        factor_flops_[j + 1]  = factor_flops_[j] + static_cast<double>(count) * static_cast<double>(count);
+    }
+}
+
+// Complexity: O(number of parts)
+auto NodalSLAE::dissection_stages(size_type number_of_domains) const -> Container::Vector<Container::Vector<Range>>
+{
+    size_type depth = 0;
+    while ((size_type{1} << depth) < number_of_domains)
+        ++depth;
+
+    Container::Vector<Container::Vector<Range>> stages (depth + 1);
+    for (const auto& part: parts_)
+    {
+        if (part.depth_ == depth || (part.depth_ < depth && part.separator_ == part.begin_)) // subdomain
+            stages[0].push_back(Range{part.begin_, part.end_});
+        else if (part.depth_ < depth && part.separator_ != part.end_)
+            stages[depth - part.depth_].push_back(Range{part.separator_, part.end_});
+    }
+    return stages;
+}
+
+// Complexity: O(number of parts)
+double NodalSLAE::dissection_flops(size_type number_of_domains) const
+{
+    number_of_domains = std::max(size_type{1}, number_of_domains);
+    double flops = 0.0;
+    for (const auto& stage: dissection_stages(number_of_domains))
+    {
+        double total = 0.0, longest = 0.0;
+        for (const auto& [first, last]: stage)
+        {
+            const auto range_flops = factor_flops_[last] - factor_flops_[first];
+            total += range_flops;
+            longest = std::max(longest, range_flops);
+        }
+        flops += std::max(total / static_cast<double>(number_of_domains), longest);
+    }
+    return flops;
+}
+
+struct NodalSLAE::Factor
+{
+    // rows_ and values_ of column K are filled up to next_[K]
+    Container::Vector<size_type> rows_   = {};
+    Container::Vector<double>    values_ = {};
+    Container::Vector<size_type> next_   = {};
+    // Dense row of factor being computed and marks of its pattern, ranges eliminated in parallel
+    // use disjoint elements of them
+    Container::Vector<double>    row_    = {};
+    Container::Vector<size_type> marks_  = {};
+}; // struct NodalSLAE::Factor
+
+// Complexity: O(sum of squared counts of columns [first, last) of factor)
+bool NodalSLAE::eliminate_dissection(const NodalMatrix& matrix, size_type first, size_type last,
+                                     Factor& factor, Container::Vector<size_type>& stack) const
+{
+    // Row K of factor solves L_K * L(K, :)^T == A(:K, K), L_K - the first K rows of factor
+    const auto size = number_of_rows_;
+    for (auto k = first; k < last; ++k)
+    {
+        // pattern of L(K, :) is union of paths up elimination tree from nonzeros of A(:K, K),
+        // it is stack[top...size] in topological order
+        auto top = size;
+        factor.marks_[k] = k;
+        const auto row = dissection_rows_[k];
+        for (auto j = row_starts_[row]; j < row_starts_[row + 1]; ++j)
+        {
+            auto i = dissection_positions_[cols_[j]];
+            if (i > k)
+                continue;
+            factor.row_[i] = matrix.values_[j];
+            size_type length = 0;
+            for (; factor.marks_[i] != k; i = etree_parents_[i])
+            {
+                stack[length++] = i;
+                factor.marks_[i] = k;
+            }
+            while (length > 0)
+                stack[--top] = stack[--length];
+        }
+
+        auto diag = matrix.diag_[row];
+        for (; top < size; ++top)
+        {
+            const auto i = stack[top];
+            const auto value = factor.row_[i] / factor.values_[factor_starts_[i]];
+            factor.row_[i] = 0.0;
+            for (auto p = factor_starts_[i] + 1; p < factor.next_[i]; ++p)
+                factor.row_[factor.rows_[p]] -= factor.values_[p] * value;
+            diag -= value * value;
+
+            const auto p = factor.next_[i]++;
+            factor.rows_[p]   = k;
+            factor.values_[p] = value;
+        }
+
+        if (!(diag > matrix.diag_[row] * 1e-14))
+            return false;
+        const auto p = factor.next_[k]++;
+        factor.rows_[p]   = k;
+        factor.values_[p] = std::sqrt(diag);
+    }
+    return true;
+}
+
+// Complexity: O(F + L)
+auto NodalSLAE::solve_schur(const NodalMatrix& matrix, size_type number_of_domains) const -> Container::Vector<double>
+{
+    const auto size = number_of_rows_;
+    number_of_domains = std::max(size_type{1}, number_of_domains);
+
+    Factor factor {Container::Vector<size_type>(factor_size()), Container::Vector<double>(factor_size()),
+                   Container::Vector<size_type>(factor_starts_.cbegin(), factor_starts_.cend() - 1),
+                   Container::Vector<double>(size), Container::Vector<size_type>(size)};
+    std::fill(factor.marks_.begin(), factor.marks_.end(), npos);
+
+    std::atomic<bool> failed {false};
+    for (const auto& stage: dissection_stages(number_of_domains)) // F iterations
+    {
+        std::atomic<size_type> next {0};
+        run_in_parallel(std::min(number_of_domains, stage.size()), [&](size_type)
+        {
+            Container::Vector<size_type> stack (size);
+            for (auto i = next.fetch_add(1); i < stage.size() && !failed; i = next.fetch_add(1))
+                if (!eliminate_dissection(matrix, stage[i].first, stage[i].second, factor, stack))
+                    failed = true;
+        });
+        if (failed)
+            return Container::Vector<double>{};
+    }
+    for (size_type j = 0; j < size; ++j)
+        assert(factor.next_[j] == factor_starts_[j + 1]);
+
+    Container::Vector<double> solution (size);
+    for (size_type k = 0; k < size; ++k) // M iterations
+        solution[k] = matrix.rhs_[dissection_rows_[k]];
+    for (size_type j = 0; j < size; ++j) // L * y == rhs, L iterations
+    {
+        solution[j] /= factor.values_[factor_starts_[j]];
+        for (auto p = factor_starts_[j] + 1; p < factor_starts_[j + 1]; ++p)
+            solution[factor.rows_[p]] -= factor.values_[p] * solution[j];
+    }
+    for (auto j = size; j-- > 0;) // L^T * x == y, L iterations
+    {
+        for (auto p = factor_starts_[j] + 1; p < factor_starts_[j + 1]; ++p)
+            solution[j] -= factor.values_[p] * solution[factor.rows_[p]];
+        solution[j] /= factor.values_[factor_starts_[j]];
+    }
+
+    Container::Vector<double> potentials (size);
+    for (size_type k = 0; k < size; ++k) // M iterations
+        potentials[dissection_rows_[k]] = solution[k];
+    return potentials;
+}
+
+// Complexity: O(I * (M + Z)), I - number of iterations
+auto NodalSLAE::solve_conjugate_gradient(const NodalMatrix& matrix, double tolerance) const -> Container::Vector<double>
+{
+    const auto size = number_of_rows_;
+    auto dot = [size](const Container::Vector<double>& lhs, const Container::Vector<double>& rhs)
+    {
+        double sum = 0.0;
+        for (size_type i = 0; i < size; ++i)
+            sum += lhs[i] * rhs[i];
+        return sum;
+    };
+
+    Container::Vector<double> potentials (size);
+    auto residual = matrix.rhs_;
+    const auto rhs_norm = std::sqrt(dot(residual, residual));
+    if (rhs_norm == 0.0)
+        return potentials;
+
+    Container::Vector<double> preconditioned (size);
+    for (size_type i = 0; i < size; ++i) // M iterations
+        preconditioned[i] = residual[i] / matrix.diag_[i];
+    auto direction = preconditioned;
+    auto product = dot(residual, preconditioned);
+    Container::Vector<double> mult (size);
+
+    for (size_type iteration = 0; iteration < 2 * size + 10; ++iteration) // I iterations
+    {
+        for (size_type i = 0; i < size; ++i) // M + Z iterations
+        {
+            auto sum = matrix.diag_[i] * direction[i];
+            for (auto j = row_starts_[i]; j < row_starts_[i + 1]; ++j)
+                sum += matrix.values_[j] * direction[cols_[j]];
+            mult[i] = sum;
+        }
+
+        const auto alpha = product / dot(direction, mult);
+        for (size_type i = 0; i < size; ++i) // M iterations
+        {
+            potentials[i] += alpha * direction[i];
+            residual[i]   -= alpha * mult[i];
+        }
+        if (std::sqrt(dot(residual, residual)) <= tolerance * rhs_norm)
+        {
+            Stats::count(Stats::Counter::conjugate_gradient_iterations, iteration + 1);
+            return potentials;
+        }
+
+        for (size_type i = 0; i < size; ++i) // M iterations
+            preconditioned[i] = residual[i] / matrix.diag_[i];
+        const auto new_product = dot(residual, preconditioned);
+        const auto beta = new_product / product;
+        product = new_product;
+        for (size_type i = 0; i < size; ++i) // M iterations
+            direction[i] = preconditioned[i] + beta * direction[i];
+    }
+
+    Stats::count(Stats::Counter::conjugate_gradient_iterations, 2 * size + 10);
+    return Container::Vector<double>{};
+}
+
+// Complexity: O(N + E)
+auto NodalSLAE::make_currents(const Edges& edges, const Container::Vector<double>& offsets,
+                              const Container::Vector<double>& potentials) const -> Currents
+{
+    Currents currents (number_of_edges());
+    // inflows[I] - sum of known currents flowing in node I
+    Container::Vector<double> inflows (number_of_nodes_);
+    for (size_type i = 0; i < number_of_edges(); ++i) // E iterations
+    {
+        if (zero_resistance_[i])
+            continue;
+
+        const auto& nodes = edge_nodes_[i];
+        const auto row1 = rows_[nodes.node1_];
+        const auto row2 = rows_[nodes.node2_];
+        const auto phi1 = ((row1 == npos) ? 0.0 : potentials[row1]) + offsets[nodes.node1_];
+        const auto phi2 = ((row2 == npos) ? 0.0 : potentials[row2]) + offsets[nodes.node2_];
+        currents[i] = (edges[i].emf_ + phi1 - phi2) / edges[i].resistance_;
+        inflows[nodes.node1_] -= currents[i];
+        inflows[nodes.node2_] += currents[i];
+    }
+
+    // currents of zero-resistance edges from leaves of trees to roots
+    for (auto itr = tree_order_.size(); itr-- > 0;) // N iterations
+    {
+        const auto node = tree_order_[itr];
+        const auto edge = tree_parents_[node];
+        if (edge == npos)
+            continue;
+
+        const auto& nodes = edge_nodes_[edge];
+        if (nodes.node2_ == node)
+        {
+            currents[edge] = -inflows[node];
+            inflows[nodes.node1_] -= currents[edge];
+        }
+        else
+        {
+            currents[edge] = inflows[node];
+            inflows[nodes.node2_] += currents[edge];
+        }
+    }
+
+    return currents;
+}
+} // namespace Circuit
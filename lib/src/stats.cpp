@@ -0,0 +1,222 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+#include <sys/resource.h>
+
+namespace Circuit
+{
+namespace Stats
+{
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+struct Recorder
+{
+    std::mutex mutex_ = {};
+    clock::time_point start_ = {};
+    Report report_ = {};
+}; // struct Recorder
+
+Recorder& recorder()
+{
+    static Recorder recorder {};
+    return recorder;
+}
+
+// Connected circuit solved by this thread
+thread_local ComponentStats* current_component = nullptr;
+
+double seconds_since(clock::time_point start)
+{
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Complexity: O(1)
+void add_to_histogram(Container::Vector<std::size_t>& histogram, std::size_t value)
+{
+    const auto bucket = std::max<std::size_t>(std::bit_width(value), 1) - 1;
+    while (histogram.size() <= bucket)
+        histogram.push_back(0);
+    ++histogram[bucket];
+}
+
+void write_histogram(std::ostream& os, const Container::Vector<std::size_t>& histogram)
+{
+    os << '[';
+    for (std::size_t i = 0; i < histogram.size(); ++i)
+    {
+        const auto from = (i == 0) ? std::size_t{0} : std::size_t{1} << i;
+        os << ((i == 0) ? "" : ", ") << "{\"from\": " << from << ", \"to\": " << (std::size_t{2} << i) - 1
+           << ", \"count\": " << histogram[i] << '}';
+    }
+    os << ']';
+}
+} // namespace
+
+void enable()
+{
+    auto& rec = recorder();
+    std::lock_guard lock {rec.mutex_};
+    rec.report_ = Report{};
+    rec.start_ = clock::now();
+    detail::allocated_bytes.store(0, std::memory_order_relaxed);
+    detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+void disable()
+{
+    detail::enabled.store(false, std::memory_order_relaxed);
+}
+
+std::size_t peak_rss_kb()
+{
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<std::size_t>(usage.ru_maxrss); // kilobytes on Linux
+}
+
+void add_phase(Phase phase, double seconds, std::size_t allocated_bytes, std::size_t peak_rss_growth_kb)
+{
+    auto& rec = recorder();
+    std::lock_guard lock {rec.mutex_};
+    auto& stats = rec.report_.phases_[static_cast<std::size_t>(phase)];
+    ++stats.calls_;
+    stats.seconds_ += seconds;
+    stats.allocated_bytes_ += allocated_bytes;
+    stats.peak_rss_growth_kb_ += peak_rss_growth_kb;
+}
+
+void count(Counter counter, std::size_t value)
+{
+    if (!enabled())
+        return;
+    if (counter == Counter::pivots && current_component != nullptr)
+        current_component->pivots_ += value;
+
+    auto& rec = recorder();
+    std::lock_guard lock {rec.mutex_};
+    rec.report_.counters_[static_cast<std::size_t>(counter)] += value;
+}
+
+void Timer::record()
+{
+    const auto seconds = seconds_since(start_);
+    // peak RSS never decreases
+    add_phase(phase_, seconds, allocated_bytes() - start_bytes_, peak_rss_kb() - start_rss_kb_);
+    if (current_component == nullptr)
+        return;
+    if (phase_ == Phase::assembly)
+        current_component->assembly_seconds_ += seconds;
+    else if (phase_ == Phase::elimination)
+        current_component->elimination_seconds_ += seconds;
+}
+
+void ComponentScope::start()
+{
+    previous_ = current_component;
+    current_component = &stats_;
+    start_ = clock::now();
+    start_bytes_ = allocated_bytes();
+}
+
+// Complexity: O(log(number_of_slowest_components))
+void ComponentScope::finish()
+{
+    current_component = previous_;
+    stats_.seconds_ = seconds_since(start_);
+    stats_.allocated_bytes_ = allocated_bytes() - start_bytes_;
+
+    auto& rec = recorder();
+    std::lock_guard lock {rec.mutex_};
+    auto& report = rec.report_;
+    ++report.solvers_[static_cast<std::size_t>(stats_.solver_)];
+    add_to_histogram(report.nodes_histogram_, stats_.nodes_);
+    add_to_histogram(report.edges_histogram_, stats_.edges_);
+
+    // slowest_components_ is a min-heap by time while recording
+    auto& slowest = report.slowest_components_;
+    auto slower = [](const ComponentStats& lhs, const ComponentStats& rhs) {return lhs.seconds_ > rhs.seconds_;};
+    if (slowest.size() < number_of_slowest_components)
+    {
+        slowest.push_back(stats_);
+        std::push_heap(slowest.begin(), slowest.end(), slower);
+    }
+    else if (slowest.front().seconds_ < stats_.seconds_)
+    {
+        std::pop_heap(slowest.begin(), slowest.end(), slower);
+        slowest.back() = stats_;
+        std::push_heap(slowest.begin(), slowest.end(), slower);
+    }
+}
+
+Report report()
+{
+    const auto rss = peak_rss_kb();
+    auto& rec = recorder();
+    std::lock_guard lock {rec.mutex_};
+    auto report = rec.report_;
+    report.seconds_ = seconds_since(rec.start_);
+    report.allocated_bytes_ = allocated_bytes();
+    report.peak_rss_kb_ = rss;
+    std::sort(report.slowest_components_.begin(), report.slowest_components_.end(),
+              [](const auto& lhs, const auto& rhs) {return lhs.seconds_ > rhs.seconds_;});
+    return report;
+}
+
+void write_json(std::ostream& os, const Report& report)
+{
+    os << "{\n";
+    os << "  \"seconds\": " << report.seconds_ << ",\n";
+    os << "  \"allocated_bytes\": " << report.allocated_bytes_ << ",\n";
+    os << "  \"peak_rss_kb\": " << report.peak_rss_kb_ << ",\n";
+
+    os << "  \"phases\": {";
+    for (std::size_t i = 0; i < number_of_phases; ++i)
+    {
+        const auto& phase = report.phases_[i];
+        os << ((i == 0) ? "\n" : ",\n") << "    \"" << phase_name(static_cast<Phase>(i)) << "\": {\"calls\": " << phase.calls_
+           << ", \"seconds\": " << phase.seconds_ << ", \"allocated_bytes\": " << phase.allocated_bytes_
+           << ", \"peak_rss_growth_kb\": " << phase.peak_rss_growth_kb_ << '}';
+    }
+    os << "\n  },\n";
+
+    os << "  \"counters\": {";
+    for (std::size_t i = 0; i < number_of_counters; ++i)
+        os << ((i == 0) ? "" : ", ") << '"' << counter_name(static_cast<Counter>(i)) << "\": " << report.counters_[i];
+    os << "},\n";
+
+    os << "  \"solvers\": {";
+    for (std::size_t i = 0; i < number_of_solvers; ++i)
+    {
+        const auto solver = static_cast<Solver>(i);
+        os << ((i == 0) ? "" : ", ") << '"' << ((solver == Solver::automatic) ? "unsolved" : solver_name(solver))
+           << "\": " << report.solvers_[i];
+    }
+    os << "},\n";
+
+    os << "  \"nodes_histogram\": ";
+    write_histogram(os, report.nodes_histogram_);
+    os << ",\n  \"edges_histogram\": ";
+    write_histogram(os, report.edges_histogram_);
+    os << ",\n";
+
+    os << "  \"slowest_components\": [";
+    for (std::size_t i = 0; i < report.slowest_components_.size(); ++i)
+    {
+        const auto& component = report.slowest_components_[i];
+        os << ((i == 0) ? "\n" : ",\n") << "    {\"nodes\": " << component.nodes_ << ", \"edges\": " << component.edges_
+           << ", \"solver\": \"" << ((component.solver_ == Solver::automatic) ? "unsolved" : solver_name(component.solver_))
+           << "\", \"seconds\": " << component.seconds_ << ", \"assembly_seconds\": " << component.assembly_seconds_
+           << ", \"elimination_seconds\": " << component.elimination_seconds_
+           << ", \"allocated_bytes\": " << component.allocated_bytes_ << ", \"pivots\": " << component.pivots_ << '}';
+    }
+    os << (report.slowest_components_.empty() ? "]\n" : "\n  ]\n");
+    os << "}\n";
+}
+} // namespace Stats
+} // namespace Circuit
@@ -0,0 +1,25 @@
+#include "stats.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Replacement of global allocation functions which counts allocated bytes for Circuit::Stats.
+// operator new[] and nothrow versions call this one.
+
+void* operator new(std::size_t size)
+{
+    Circuit::Stats::count_allocation(size);
+    if (auto ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,222 @@
+#include "batch.hpp"
+#include "bounded_queue.hpp"
+#include "input_output.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <semaphore>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Circuit
+{
+namespace Batch
+{
+// Circuit on its way through pipeline, every stage fills its part and frees the previous one
+struct Item
+{
+    std::size_t number_ = 0;
+    std::string text_ = {};
+    Container::Vector<InputOutput::InputEdge> edges_ = {};
+    std::optional<Circuit> circuit_ = {};
+    Circuit::Solution solution_ = {};
+    std::string output_ = {};
+    std::string error_ = {};
+    // what solver wrote in log, it's passed to options.log_ in input order
+    std::string log_ = {};
+}; // struct Item
+
+using Queue = BoundedQueue<Item>;
+constexpr std::size_t queue_capacity = 64;
+
+// Stage applies func to every item from in and passes it to out, items with errors are passed as they are
+template<typename F>
+std::thread make_stage(Queue& in, Queue& out, F func)
+{
+    return std::thread([&in, &out, func]
+    {
+        while (auto item = in.pop())
+        {
+            if (item->error_.empty())
+                try {
+                    func(*item);
+                } catch(std::exception& exception) {
+                    item->error_ = exception.what();
+                }
+            out.push(std::move(*item));
+        }
+        out.close();
+    });
+}
+
+std::size_t run(const Reader& reader, std::ostream& os, const SolverOptions& options, std::ostream& err)
+{
+    Queue texts {queue_capacity}, parsed {queue_capacity}, split {queue_capacity},
+          solved {queue_capacity}, ordered {queue_capacity}, formatted {queue_capacity};
+
+    std::vector<std::thread> stages {};
+    // reading errors go through queues as errors of circuits, so only the output loop writes in err
+    stages.emplace_back([&reader, &texts]
+    {
+        for (std::size_t number = 1;; ++number)
+        {
+            Item item {number};
+            try {
+                auto text = reader();
+                if (!text)
+                    break;
+                item.text_ = std::move(*text);
+            } catch(std::exception& exception) {
+                item.error_ = std::string{"reading failed: "} + exception.what();
+            }
+            texts.push(std::move(item));
+        }
+        texts.close();
+    });
+    stages.push_back(make_stage(texts, parsed, [](Item& item)
+    {
+        std::istringstream is {item.text_};
+        item.edges_ = InputOutput::input(is);
+        item.text_  = std::string{};
+    }));
+    stages.push_back(make_stage(parsed, split, [](Item& item)
+    {
+        item.circuit_.emplace(item.edges_.cbegin(), item.edges_.cend());
+        item.edges_ = Container::Vector<InputOutput::InputEdge>{};
+    }));
+    // one budget of threads is divided between solvers of circuits, so schur solver of every circuit has one thread
+    const auto number_of_solvers = (options.number_of_threads_ != 0) ? options.number_of_threads_
+                                                                     : std::max(1u, std::thread::hardware_concurrency());
+    auto solver_options = options;
+    solver_options.number_of_threads_ = 1;
+
+    // Solvers take circuits out of order, so not more than queue_capacity of them are taken
+    // and not passed in order yet, otherwise slow circuit would make the others pile up
+    std::counting_semaphore<queue_capacity> in_flight {queue_capacity};
+    std::atomic<std::size_t> running_solvers {number_of_solvers};
+    for (std::size_t i = 0; i < number_of_solvers; ++i)
+        stages.emplace_back([&split, &solved, &solver_options, &in_flight, &running_solvers]
+        {
+            for (;;)
+            {
+                in_flight.acquire();
+                auto item = split.pop();
+                if (!item)
+                {
+                    in_flight.release();
+                    break;
+                }
+                if (item->error_.empty())
+                    try {
+                        std::ostringstream log {};
+                        auto item_options = solver_options;
+                        if (solver_options.log_)
+                            item_options.log_ = &log;
+                        item->solution_ = item->circuit_->solve_circuit(item_options);
+                        item->log_ = log.str();
+                    } catch(std::exception& exception) {
+                        item->error_ = exception.what();
+                    }
+                item->circuit_.reset();
+                solved.push(std::move(*item));
+            }
+            if (running_solvers.fetch_sub(1) == 1)
+                solved.close();
+        });
+    // items are numbered from 1 without gaps, so they are put back in input order by their numbers
+    stages.emplace_back([&solved, &ordered, &in_flight]
+    {
+        std::map<std::size_t, Item> pending {};
+        std::size_t next = 1;
+        while (auto item = solved.pop())
+        {
+            pending.emplace(item->number_, std::move(*item));
+            for (auto it = pending.begin(); it != pending.end() && it->first == next; it = pending.erase(it), ++next)
+            {
+                ordered.push(std::move(it->second));
+                in_flight.release();
+            }
+        }
+        ordered.close();
+    });
+    stages.push_back(make_stage(ordered, formatted, [](Item& item)
+    {
+        std::ostringstream output {};
+        InputOutput::output(item.solution_.cbegin(), item.solution_.cend(), output);
+        item.output_   = output.str();
+        item.solution_ = Circuit::Solution{};
+    }));
+
+    // stages after reordering are one thread, so items come in input order
+    std::size_t failed = 0;
+    for (bool first = true; auto item = formatted.pop(); first = false)
+    {
+        if (options.log_)
+            *options.log_ << item->log_;
+        if (!first)
+            os << '\n';
+        if (item->error_.empty())
+            os << item->output_;
+        else
+        {
+            err << "circuit " << item->number_ << ": " << item->error_ << '\n';
+            ++failed;
+        }
+    }
+    os.flush();
+
+    for (auto& stage: stages)
+        stage.join();
+    return failed;
+}
+
+std::size_t run(std::istream& is, std::ostream& os, const SolverOptions& options, std::ostream& err)
+{
+    auto is_blank = [](const std::string& line)
+    {
+        return std::all_of(line.cbegin(), line.cend(), [](unsigned char sym){return std::isspace(sym);});
+    };
+
+    return run([&is, &is_blank]() -> std::optional<std::string>
+    {
+        std::string text {}, line {};
+        while (std::getline(is, line))
+        {
+            if (!is_blank(line))
+                text += line + '\n';
+            else if (!text.empty())
+                return text;
+        }
+        if (text.empty())
+            return std::nullopt;
+        return text;
+    }, os, options, err);
+}
+
+std::size_t run(const std::filesystem::path& directory, std::ostream& os, const SolverOptions& options, std::ostream& err)
+{
+    std::vector<std::filesystem::path> files {};
+    for (const auto& entry: std::filesystem::directory_iterator{directory})
+        if (entry.is_regular_file())
+            files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+
+    return run([&files, next = std::size_t{0}]() mutable -> std::optional<std::string>
+    {
+        if (next == files.size())
+            return std::nullopt;
+
+        std::ifstream file {files[next++]};
+        if (!file)
+            throw std::runtime_error{"cannot open " + files[next - 1].string()};
+        std::ostringstream text {};
+        text << file.rdbuf();
+        return text.str();
+    }, os, options, err);
+}
+} // namespace Batch
+} // namespace Circuit
@@ -1,15 +1,93 @@
 #include "circuit.hpp"
 #include "input_output.hpp"
+#include "batch.hpp"
+#include "server.hpp"
 
-int main()
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
+// Sends circuit from std::cin to server and prints its response
+static int run_client(const std::filesystem::path& path, bool binary)
 {
-    try {
+    Circuit::Server::Frame request {};
+    if (binary)
+    {
+        request.kind_ = Circuit::Server::Kind::binary;
+        request.payload_ = Circuit::Server::encode_binary(Circuit::InputOutput::input());
+    }
+    else
+        request.payload_.assign(std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{});
+
+    Circuit::Server::Client client {path};
+    const auto response = client.solve(request);
+    if (response.kind_ == Circuit::Server::Kind::error)
+    {
+        std::cerr << response.payload_ << std::endl;
+        return 1;
+    }
+    std::cout << response.payload_ << std::flush;
+    return 0;
+}
+
+// Removes --stats=json from arguments, true if it was there
+static bool take_stats_flag(int& argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+        if (std::string_view{argv[i]} == "--stats=json")
+        {
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            --argc;
+            return true;
+        }
+    return false;
+}
+
+static int run(int argc, char** argv)
+{
+    // batch fails if any of its circuits fails
+    if (argc > 1 && std::string_view{argv[1]} == "--batch")
+    {
+        const auto failed = (argc > 2) ? Circuit::Batch::run(std::filesystem::path{argv[2]}, std::cout)
+                                       : Circuit::Batch::run(std::cin, std::cout);
+        return (failed == 0) ? 0 : 1;
+    }
+
+    if (argc > 2 && std::string_view{argv[1]} == "--server")
+    {
+        Circuit::Server::ServerOptions options {};
+        if (argc > 4 && std::string_view{argv[3]} == "--workers")
+            options.number_of_workers_ = std::stoul(argv[4]);
+        Circuit::Server::run(argv[2], options);
+        return 0;
+    }
+
+    if (argc > 2 && std::string_view{argv[1]} == "--client")
+        return run_client(argv[2], argc > 3 && std::string_view{argv[3]} == "--binary");
+
     auto edges = Circuit::InputOutput::input();
     Circuit::Circuit circuit (edges.cbegin(), edges.cend());
     auto solution = circuit.solve_circuit();
     Circuit::InputOutput::output(solution.cbegin(), solution.cend());
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    // Report of --stats=json goes to stderr, so output stays the same
+    const auto stats = take_stats_flag(argc, argv);
+    if (stats)
+        Circuit::Stats::enable();
+
+    auto result = 0;
+    try {
+        result = run(argc, argv);
     } catch(std::exception& exception) {
         std::cerr << exception.what() << std::endl;
+        result = 1;
     }
-    return 0;
-}
\ No newline at end of file
+
+    if (stats)
+        Circuit::Stats::write_json(std::cerr, Circuit::Stats::report());
+    return result;
+}
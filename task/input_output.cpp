@@ -69,23 +69,25 @@ InputEdge scan_edge(const std::string& str)
     return InputEdge{node1, node2, res, emf};
 }
 
-Container::Vector<InputEdge> input()
+Container::Vector<InputEdge> input(std::istream& is)
 {
+    Stats::Timer parse {Stats::Phase::parse};
     Container::Vector<InputEdge> edges {};
     std::string str {};
-    while (std::getline(std::cin, str))
+    while (std::getline(is, str))
         edges.push_back(scan_edge(str));
     return edges;
 }
 
-void output(SolutionIt first, SolutionIt last)
+void output(SolutionIt first, SolutionIt last, std::ostream& os)
 {
+    Stats::Timer output {Stats::Phase::output};
     for (; first != last; ++first)
     {
-        std::cout << first->first.node1_ << " -- " << first->first.node2_ << ": ";
-        std::cout << first->second << " A\n";
+        os << first->first.node1_ << " -- " << first->first.node2_ << ": ";
+        os << first->second << " A\n";
     }
-    std::cout.flush();
+    os.flush();
 }
 
 } // namespace InputOutput
@@ -0,0 +1,541 @@
+#include "server.hpp"
+#include "bounded_queue.hpp"
+#include "input_output.hpp"
+
+#include <cerrno>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Circuit
+{
+namespace Server
+{
+// Client trusts server more than server trusts clients
+constexpr std::uint64_t max_response_size = std::uint64_t{1} << 32;
+// Worker waits that long for the rest of request and for client reading response
+constexpr int io_timeout_seconds = 10;
+
+// Lock-free atomics may be used in signal handlers
+static std::atomic<bool> stop_requested {false};
+// Writing end of pipe waking up poll() of running server, -1 if server isn't running
+static std::atomic<int> wake_up_pipe {-1};
+
+static void request_stop(int)
+{
+    stop_requested = true;
+    if (const auto pipe = wake_up_pipe.load(); pipe >= 0)
+    {
+        const char byte = 0;
+        [[maybe_unused]] const auto written = ::write(pipe, &byte, 1);
+    }
+}
+
+static std::runtime_error system_error(const std::string& what)
+{
+    return std::runtime_error{what + ": " + std::strerror(errno)};
+}
+
+static sockaddr_un make_address(const std::filesystem::path& path)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    const auto& str = path.string();
+    if (str.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument{"socket path is too long"};
+    std::copy(str.cbegin(), str.cend(), address.sun_path);
+    return address;
+}
+
+// false if connection was closed before the first byte
+static bool read_exact(int socket, char* buffer, std::size_t size)
+{
+    for (std::size_t done = 0; done < size;)
+    {
+        const auto got = ::recv(socket, buffer + done, size - done, 0);
+        if (got == 0 && done == 0)
+            return false;
+        if (got == 0)
+            throw std::runtime_error{"connection closed in the middle of frame"};
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            throw std::runtime_error{"timeout while reading frame"};
+        if (got < 0 && errno != EINTR)
+            throw system_error("recv");
+        if (got > 0)
+            done += static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+static void write_all(int socket, const char* buffer, std::size_t size)
+{
+    for (std::size_t done = 0; done < size;)
+    {
+        const auto sent = ::send(socket, buffer + done, size - done, MSG_NOSIGNAL);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            throw std::runtime_error{"timeout while writing frame"};
+        if (sent < 0 && errno != EINTR)
+            throw system_error("send");
+        if (sent > 0)
+            done += static_cast<std::size_t>(sent);
+    }
+}
+
+// payload buffer is reused, false if connection was closed.
+// Throws std::length_error if payload is bigger than max_size, payload is left unread then.
+static bool read_frame(int socket, Frame& frame, std::uint64_t max_size)
+{
+    char header[1 + sizeof(std::uint64_t)] {};
+    if (!read_exact(socket, header, 1))
+        return false;
+    read_exact(socket, header + 1, sizeof(std::uint64_t));
+
+    std::uint64_t size = 0;
+    std::memcpy(&size, header + 1, sizeof(size));
+    if (size > max_size)
+        throw std::length_error{"frame of " + std::to_string(size) + " bytes is bigger than limit of "
+                                + std::to_string(max_size) + " bytes"};
+
+    frame.kind_ = static_cast<Kind>(header[0]);
+    frame.payload_.resize(size);
+    read_exact(socket, frame.payload_.data(), size);
+    return true;
+}
+
+static void write_frame(int socket, const Frame& frame)
+{
+    char header[1 + sizeof(std::uint64_t)] {static_cast<char>(frame.kind_)};
+    const std::uint64_t size = frame.payload_.size();
+    std::memcpy(header + 1, &size, sizeof(size));
+    write_all(socket, header, sizeof(header));
+    write_all(socket, frame.payload_.data(), frame.payload_.size());
+}
+
+std::string encode_binary(const Container::Vector<InputOutput::InputEdge>& edges)
+{
+    std::string payload (edges.size() * binary_edge_size, '\0');
+    auto itr = payload.data();
+    for (const auto& edge: edges)
+    {
+        const std::uint32_t nodes[] = {edge.node1_, edge.node2_};
+        const double values[] = {edge.resistance_, edge.emf_};
+        std::memcpy(itr, nodes, sizeof(nodes));
+        std::memcpy(itr + sizeof(nodes), values, sizeof(values));
+        itr += binary_edge_size;
+    }
+    return payload;
+}
+
+// Buffers of worker reused between requests
+struct Scratch
+{
+    Frame request_ = {};
+    std::vector<InputOutput::InputEdge> edges_ = {};
+    std::string line_ = {};
+    std::ostringstream output_ = {};
+}; // struct Scratch
+
+static void decode_request(const Frame& request, Scratch& scratch)
+{
+    auto& edges = scratch.edges_;
+    edges.clear();
+    const auto& payload = request.payload_;
+
+    if (request.kind_ == Kind::binary)
+    {
+        if (payload.size() % binary_edge_size != 0)
+            throw std::invalid_argument{"size of binary circuit isn't multiple of edge size"};
+        for (auto itr = payload.data(); itr != payload.data() + payload.size(); itr += binary_edge_size)
+        {
+            std::uint32_t nodes[2] {};
+            double values[2] {};
+            std::memcpy(nodes, itr, sizeof(nodes));
+            std::memcpy(values, itr + sizeof(nodes), sizeof(values));
+            edges.push_back(InputOutput::InputEdge{nodes[0], nodes[1], values[0], values[1]});
+        }
+        return;
+    }
+
+    if (request.kind_ != Kind::text)
+        throw std::invalid_argument{"unknown kind of request"};
+    for (std::size_t first = 0; first < payload.size();)
+    {
+        auto last = payload.find('\n', first);
+        if (last == std::string::npos)
+            last = payload.size();
+        scratch.line_.assign(payload, first, last - first);
+        if (!scratch.line_.empty())
+            edges.push_back(InputOutput::scan_edge(scratch.line_));
+        first = last + 1;
+    }
+}
+
+static Frame solve(const Frame& request, Scratch& scratch, const SolverOptions& options)
+{
+    try {
+        decode_request(request, scratch);
+        const Circuit circuit (scratch.edges_.cbegin(), scratch.edges_.cend());
+        const auto& solution = circuit.solve_circuit(options);
+
+        auto& output = scratch.output_;
+        output.str(std::string{});
+        InputOutput::output(solution.cbegin(), solution.cend(), output);
+        return Frame{Kind::ok, output.str()};
+    } catch(std::exception& exception) {
+        return Frame{Kind::error, exception.what()};
+    }
+}
+
+// LRU cache of responses by content of requests. The first worker which gets request missing in cache solves it,
+// the others getting the same request meanwhile wait for its response. Error responses aren't cached.
+class Cache final
+{
+    struct Entry
+    {
+        std::uint64_t hash_ = 0;
+        std::string request_ = {}; // kind and payload
+        Frame response_ = {};
+
+        std::size_t size() const {return request_.size() + response_.payload_.size();}
+    }; // struct Entry
+
+    struct InFlight
+    {
+        std::string request_ = {};
+        std::shared_future<Frame> response_ = {};
+    }; // struct InFlight
+
+    std::list<Entry> entries_ = {}; // from the most recently used
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_ = {};
+    std::unordered_map<std::uint64_t, InFlight> in_flight_ = {};
+    std::size_t size_ = 0, capacity_ = 0;
+    std::mutex mutex_ = {};
+
+    // FNV-1a
+    static std::uint64_t hash(const std::string& request)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (auto sym: request)
+        {
+            hash ^= static_cast<unsigned char>(sym);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void insert(std::uint64_t hash, std::string&& request, const Frame& response)
+    {
+        if (auto itr = index_.find(hash); itr != index_.end())
+        {
+            size_ -= itr->second->size();
+            entries_.erase(itr->second);
+            index_.erase(itr);
+        }
+
+        Entry entry {hash, std::move(request), response};
+        if (entry.size() > capacity_)
+            return;
+        for (; size_ + entry.size() > capacity_; entries_.pop_back()) // evict the least recently used
+        {
+            size_ -= entries_.back().size();
+            index_.erase(entries_.back().hash_);
+        }
+        size_ += entry.size();
+        entries_.push_front(std::move(entry));
+        index_[hash] = entries_.begin();
+    }
+
+public:
+    explicit Cache(std::size_t capacity): capacity_ {capacity} {}
+
+    template<typename F>
+    Frame get_or_solve(const Frame& frame, F solve)
+    {
+        auto request = static_cast<char>(frame.kind_) + frame.payload_;
+        const auto request_hash = hash(request);
+
+        std::promise<Frame> promise {};
+        bool owner = false; // this thread solves request for the others getting it meanwhile
+        {
+            std::unique_lock lock {mutex_};
+            if (auto itr = index_.find(request_hash); itr != index_.end() && itr->second->request_ == request)
+            {
+                entries_.splice(entries_.begin(), entries_, itr->second);
+                return itr->second->response_;
+            }
+            if (auto itr = in_flight_.find(request_hash); itr != in_flight_.end())
+            {
+                if (itr->second.request_ == request)
+                {
+                    auto response = itr->second.response_;
+                    lock.unlock();
+                    return response.get();
+                }
+            }
+            else
+            {
+                in_flight_.emplace(request_hash, InFlight{request, promise.get_future().share()});
+                owner = true;
+            }
+        }
+
+        Frame response {};
+        try {
+            response = solve();
+        } catch(...) {
+            if (owner) // waiters get the same exception
+            {
+                std::lock_guard lock {mutex_};
+                promise.set_exception(std::current_exception());
+                in_flight_.erase(request_hash);
+            }
+            throw;
+        }
+        if (!owner) // hash collision with request in flight
+            return response;
+
+        std::lock_guard lock {mutex_};
+        promise.set_value(response);
+        in_flight_.erase(request_hash);
+        if (response.kind_ != Kind::error) // errors may be caused by state of server (lack of memory), not by request
+            insert(request_hash, std::move(request), response);
+        return response;
+    }
+}; // class Cache
+
+// Reads one request and answers it, false if connection is closed or has to be closed
+static bool serve_request(int socket, Scratch& scratch, Cache& cache, const ServerOptions& options)
+{
+    try {
+        if (!read_frame(socket, scratch.request_, options.max_request_size_))
+            return false;
+    } catch(std::length_error& error) { // rest of connection can't be parsed
+        write_frame(socket, Frame{Kind::error, error.what()});
+        return false;
+    }
+
+    const auto& response = cache.get_or_solve(scratch.request_, [&]
+    {
+        return solve(scratch.request_, scratch, options.solver_options_);
+    });
+    write_frame(socket, response);
+    return true;
+}
+
+// Connections handed back by workers to run(), writing in pipe wakes up its poll()
+class Returns final
+{
+    std::mutex mutex_ = {};
+    std::vector<std::pair<int, bool>> sockets_ = {}; // socket and whether connection stays open
+    int pipe_[2] = {-1, -1};
+
+public:
+    Returns()
+    {
+        if (::pipe2(pipe_, O_NONBLOCK | O_CLOEXEC) < 0)
+            throw system_error("pipe");
+    }
+
+    Returns(const Returns&) = delete;
+    Returns& operator=(const Returns&) = delete;
+
+    ~Returns()
+    {
+        ::close(pipe_[0]);
+        ::close(pipe_[1]);
+    }
+
+    int wake_up_descriptor() const {return pipe_[0];}
+    int wake_up_writing_descriptor() const {return pipe_[1];}
+
+    void push(int socket, bool open)
+    {
+        {
+            std::lock_guard lock {mutex_};
+            sockets_.emplace_back(socket, open);
+        }
+        const char byte = 0;
+        [[maybe_unused]] const auto written = ::write(pipe_[1], &byte, 1); // full pipe wakes up poll() anyway
+    }
+
+    std::vector<std::pair<int, bool>> take()
+    {
+        char buffer[64] {};
+        while (::read(pipe_[0], buffer, sizeof(buffer)) > 0) {}
+        std::lock_guard lock {mutex_};
+        return std::exchange(sockets_, {});
+    }
+}; // class Returns
+
+static void set_timeouts(int socket)
+{
+    const timeval timeout {io_timeout_seconds, 0};
+    ::setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+void run(const std::filesystem::path& path, const ServerOptions& options)
+{
+    const auto address = make_address(path);
+    const auto listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+        throw system_error("socket");
+
+    std::error_code ignored {};
+    if (std::filesystem::is_socket(path, ignored))
+        std::filesystem::remove(path, ignored);
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, SOMAXCONN) < 0)
+    {
+        ::close(listener);
+        throw system_error("cannot listen " + path.string());
+    }
+
+    const auto number_of_workers = (options.number_of_workers_ != 0) ? options.number_of_workers_
+                                                                     : std::max(1u, std::thread::hardware_concurrency());
+    Cache cache {options.cache_size_};
+    Returns returns {};
+
+    stop_requested = false;
+    wake_up_pipe = returns.wake_up_writing_descriptor();
+    const auto old_sigint  = std::signal(SIGINT, request_stop);
+    const auto old_sigterm = std::signal(SIGTERM, request_stop);
+    // every connection is at most once in queue, so it never gets full
+    BoundedQueue<int> requests {std::max<std::size_t>(options.max_connections_, 1)};
+    std::vector<std::thread> workers {};
+    for (std::size_t i = 0; i < number_of_workers; ++i)
+        workers.emplace_back([&]
+        {
+            // on stack GCC 12 takes request_.payload_ for uninitialized in destructor (-Wmaybe-uninitialized)
+            const auto scratch = std::make_unique<Scratch>();
+            while (auto socket = requests.pop())
+            {
+                auto open = false;
+                try {
+                    open = serve_request(*socket, *scratch, cache, options);
+                } catch(std::exception& exception) {
+                    std::cerr << "connection dropped: " << exception.what() << std::endl;
+                } catch(...) {
+                    std::cerr << "connection dropped: unknown error" << std::endl;
+                }
+                returns.push(*socket, open);
+            }
+        });
+
+    // Only this thread opens and closes connections, idle ones wait here for requests
+    std::unordered_set<int> connections {};
+    std::vector<int> idle {}, still_idle {};
+    std::vector<pollfd> polls {};
+    while (!stop_requested)
+    {
+        polls.clear();
+        polls.push_back(pollfd{listener, POLLIN, 0});
+        polls.push_back(pollfd{returns.wake_up_descriptor(), POLLIN, 0});
+        for (const auto socket: idle)
+            polls.push_back(pollfd{socket, POLLIN, 0});
+        if (::poll(polls.data(), polls.size(), 200) <= 0)
+            continue;
+
+        still_idle.clear();
+        for (std::size_t i = 2; i < polls.size(); ++i)
+            if (polls[i].revents == 0 || !requests.try_push(polls[i].fd)) // hang up is handed too: worker sees it
+                still_idle.push_back(polls[i].fd);
+        idle.swap(still_idle);
+
+        for (const auto& [socket, open]: returns.take())
+            if (open)
+                idle.push_back(socket);
+            else
+            {
+                connections.erase(socket);
+                ::close(socket);
+            }
+
+        if (polls[0].revents == 0)
+            continue;
+        const auto socket = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (socket < 0)
+            continue;
+        set_timeouts(socket);
+        if (connections.size() >= options.max_connections_)
+        {
+            try {
+                write_frame(socket, Frame{Kind::error, "too many connections"});
+            } catch(std::exception&) {}
+            ::close(socket);
+            continue;
+        }
+        connections.insert(socket);
+        idle.push_back(socket);
+    }
+
+    // Workers blocked in reading get end of connection, requests being solved are still answered
+    for (const auto socket: connections)
+        ::shutdown(socket, SHUT_RD);
+    requests.close();
+    for (auto& worker: workers)
+        worker.join();
+    for (const auto socket: connections)
+        ::close(socket);
+    ::close(listener);
+    std::filesystem::remove(path, ignored);
+
+    std::signal(SIGINT, old_sigint);
+    std::signal(SIGTERM, old_sigterm);
+    wake_up_pipe = -1;
+}
+
+void stop()
+{
+    request_stop(0);
+}
+
+Client::Client(const std::filesystem::path& path)
+:socket_ {::socket(AF_UNIX, SOCK_STREAM, 0)}
+{
+    if (socket_ < 0)
+        throw system_error("socket");
+
+    const auto address = make_address(path);
+    if (::connect(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        ::close(socket_);
+        throw system_error("cannot connect " + path.string());
+    }
+}
+
+Client::~Client()
+{
+    ::close(socket_);
+}
+
+Frame Client::solve(const Frame& request)
+{
+    try {
+        write_frame(socket_, request);
+    } catch(std::runtime_error&) {
+        // server may reject request before reading all of it, its answer is read below
+    }
+    Frame response {};
+    if (!read_frame(socket_, response, max_response_size))
+        throw std::runtime_error{"server closed connection"};
+    return response;
+}
+} // namespace Server
+} // namespace Circuit
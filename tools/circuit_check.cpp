@@ -0,0 +1,97 @@
+#include "input_output.hpp"
+#include "residuals.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+// Checks output of currents without solving circuit again: residuals of Kirchhoff's laws are computed in O(N + E)
+//     circuit_check CIRCUIT_FILE OUTPUT_FILE [--tolerance TOLERANCE]
+// Exit code is 0 if max residual isn't bigger than tolerance, 1 otherwise.
+// currents prints 6 significant digits, so residuals of its output are about 1e-6 and grow with length of loops.
+
+namespace
+{
+constexpr std::string_view usage = "usage: circuit_check CIRCUIT_FILE OUTPUT_FILE [--tolerance TOLERANCE]\n";
+
+// Currents from lines "node1 -- node2: current A" in order of edges, edges of unsolved circuits
+// are printed with nan current
+Container::Vector<double> read_currents(std::istream& is, const Container::Vector<Circuit::InputOutput::InputEdge>& edges)
+{
+    Container::Vector<double> currents {};
+    currents.reserve(edges.size());
+    std::string line {};
+    while (std::getline(is, line))
+    {
+        if (line.empty())
+            continue;
+        if (currents.size() == edges.size())
+            throw std::invalid_argument{"output has more edges than circuit"};
+
+        char* end = nullptr;
+        const auto node1 = std::strtoul(line.c_str(), &end, 10);
+        const auto dashes = line.find("--", static_cast<std::size_t>(end - line.c_str()));
+        const auto colon = line.find(':');
+        if (dashes == std::string::npos || colon == std::string::npos)
+            throw std::invalid_argument{"invalid output line: " + line};
+        const auto node2 = std::strtoul(line.c_str() + dashes + 2, nullptr, 10);
+        const auto current = std::strtod(line.c_str() + colon + 1, nullptr);
+
+        const auto& edge = edges[currents.size()];
+        if (node1 != edge.node1_ || node2 != edge.node2_)
+            throw std::invalid_argument{"output line doesn't match edge " + std::to_string(currents.size() + 1) + ": " + line};
+        currents.push_back(current);
+    }
+    if (currents.size() != edges.size())
+        throw std::invalid_argument{"output has less edges than circuit"};
+    return currents;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    try {
+    double tolerance = 1e-4;
+    if (argc > 4 && std::string_view{argv[3]} == "--tolerance")
+        tolerance = std::stod(argv[4]);
+
+    std::ifstream circuit_file {argv[1]}, output_file {argv[2]};
+    if (!circuit_file || !output_file)
+        throw std::invalid_argument{"cannot open input files"};
+
+    const auto& edges = Circuit::InputOutput::input(circuit_file);
+    const auto& currents = read_currents(output_file, edges);
+    const auto& residuals = Circuit::compute_residuals(edges, currents);
+
+    std::cout << "checked nodes: " << residuals.number_of_checked_nodes_
+              << ", checked edges: " << residuals.number_of_checked_edges_
+              << ", unsolved edges: " << residuals.number_of_unsolved_edges_ << '\n';
+    std::cout << "KCL residual: max " << residuals.max_kcl_ << " at node " << residuals.worst_node_
+              << ", rms " << residuals.rms_kcl_ << '\n';
+    std::cout << "KVL residual: max " << residuals.max_kvl_;
+    if (residuals.worst_edge_ != Circuit::Residuals::npos)
+    {
+        const auto& edge = edges[residuals.worst_edge_];
+        std::cout << " at edge " << edge.node1_ << " -- " << edge.node2_;
+    }
+    std::cout << ", rms " << residuals.rms_kvl_ << std::endl;
+
+    if (residuals.max() > tolerance)
+    {
+        std::cout << "FAILED: residual is bigger than " << tolerance << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    } catch(std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "circuit_generators.hpp"
+
+#include <charconv>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Writes circuit of chosen family in input format of currents to stdout:
+//     circuit_gen FAMILY NUMBER_OF_NODES [--seed SEED] [--degree AVERAGE_DEGREE] [--component COMPONENT_SIZE]
+// Edges are written as they are generated, circuit is never kept in memory.
+
+namespace
+{
+constexpr std::string_view usage =
+    "usage: circuit_gen grid|ladder|random_sparse|many_components|giant_component NUMBER_OF_NODES\n"
+    "                   [--seed SEED] [--degree AVERAGE_DEGREE] [--component COMPONENT_SIZE]\n";
+
+class Writer final
+{
+    std::ostream& os_;
+    std::string line_ = {};
+
+    template<typename T>
+    void append(T value)
+    {
+        char buffer[32] {};
+        line_.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    }
+
+public:
+    explicit Writer(std::ostream& os): os_ {os} {}
+
+    void operator()(const Circuit::InputOutput::InputEdge& edge)
+    {
+        line_.clear();
+        append(edge.node1_);
+        line_ += " -- ";
+        append(edge.node2_);
+        line_ += ", ";
+        append(edge.resistance_);
+        line_ += ';';
+        if (edge.emf_ != 0.0)
+        {
+            line_ += ' ';
+            append(edge.emf_);
+            line_ += 'V';
+        }
+        line_ += '\n';
+        os_ << line_;
+    }
+}; // class Writer
+// Throws std::invalid_argument if str isn't a number in [min, max of unsigned]
+unsigned parse_size(const char* str, unsigned min, std::string_view what)
+{
+    const std::string_view view {str};
+    unsigned value = 0;
+    const auto [end, error] = std::from_chars(view.data(), view.data() + view.size(), value);
+    if (error != std::errc{} || end != view.data() + view.size() || value < min)
+        throw std::invalid_argument{std::string{what} + " must be a number from " + std::to_string(min)
+                                    + " to " + std::to_string(std::numeric_limits<unsigned>::max())};
+    return value;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    try {
+    const std::string_view family {argv[1]};
+    // every family needs two nodes for one edge
+    const auto number_of_nodes = parse_size(argv[2], 2, "NUMBER_OF_NODES");
+    std::uint64_t seed = 1;
+    double degree = 0.0;
+    unsigned component_size = 8;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        const std::string_view option {argv[i]};
+        if (option == "--seed")
+            seed = std::stoull(argv[i + 1]);
+        else if (option == "--degree")
+        {
+            degree = std::stod(argv[i + 1]);
+            if (!(degree > 0.0))
+                throw std::invalid_argument{"AVERAGE_DEGREE must be positive"};
+        }
+        else if (option == "--component")
+            component_size = parse_size(argv[i + 1], 2, "COMPONENT_SIZE");
+        else
+            throw std::invalid_argument{"unknown option " + std::string{option}};
+    }
+    if (family == "many_components" && component_size > number_of_nodes)
+        throw std::invalid_argument{"COMPONENT_SIZE must not be bigger than NUMBER_OF_NODES"};
+
+    std::ios::sync_with_stdio(false);
+    Writer writer {std::cout};
+    namespace Gen = Circuit::Generators;
+    if (family == "grid")
+    {
+        unsigned side = 1;
+        while ((side + 1) * (side + 1) <= number_of_nodes)
+            ++side;
+        Gen::grid(side, side, writer, seed);
+    }
+    else if (family == "ladder")
+        Gen::ladder(number_of_nodes / 2, writer, seed);
+    else if (family == "random_sparse")
+        Gen::random_sparse(number_of_nodes, writer, (degree != 0.0) ? degree : 3.0, seed);
+    else if (family == "many_components")
+        Gen::many_components(number_of_nodes / component_size, component_size, writer, (degree != 0.0) ? degree : 3.0, seed);
+    else if (family == "giant_component")
+        Gen::giant_component(number_of_nodes, writer, (degree != 0.0) ? degree : 4.0, seed);
+    else
+    {
+        std::cerr << usage;
+        return 1;
+    }
+    std::cout.flush();
+    } catch(std::invalid_argument& exception) {
+        std::cerr << exception.what() << '\n' << usage;
+        return 1;
+    } catch(std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,6 +2,22 @@
 
 #include "matrix_slae.hpp"
 #include "circuit.hpp"
+#include "circuit_pattern.hpp"
+#include "circuit_generators.hpp"
+#include "residuals.hpp"
+#include "server.hpp"
+#include "batch.hpp"
+#include "bounded_queue.hpp"
+#include "input_output.hpp"
+
+#include <fstream>
+#include <future>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
 
 struct DblCmp
 {
@@ -160,6 +176,16 @@ TEST(ConnectedCircuit, solve_circuitCornerCase)
     EXPECT_TRUE(dbl_cmp(solution3[2].second, 0.0));
     EXPECT_TRUE(dbl_cmp(solution3[3].second, 1.0));
     EXPECT_TRUE(dbl_cmp(solution3[4].second, 1.0));
+
+    // huge resistances next to incidence coefficients of dense slae aren't taken for singularity
+    Circuit::ConnectedCircuit cir4 {
+        {1, 2, 1e9, 1.0},
+        {2, 1, 1e9}
+    };
+    const auto& solution4 = cir4.solve_circuit();
+    ASSERT_EQ(solution4.size(), 2);
+    EXPECT_NEAR(solution4[0].second, 5e-10, 1e-18);
+    EXPECT_NEAR(solution4[1].second, 5e-10, 1e-18);
 }
 
 TEST(Circuit, solve_circuitConnectedCase)
@@ -329,6 +355,704 @@ TEST(Circuit, solve_circuitMultiEdgeCase)
     EXPECT_TRUE(dbl_cmp(solution3[4].second, 0.714286));
 }
 
+TEST(Circuit, currentLazyQueries)
+{
+    const Circuit::Circuit cir {
+        {1, 2, 1.0},
+        {1, 3, 1.0},
+        {2, 3, 1.0, 3.0},
+        {4, 5, 1.0},
+        {4, 6, 1.0},
+        {5, 6, 1.0, 3.0},
+        {7, 8, 1.0, 2.0},
+        {7, 8, 1.0}
+    };
+    EXPECT_EQ(cir.number_of_connected_circuits(), 3);
+    EXPECT_EQ(cir.number_of_solved_circuits(), 0);
+
+    const auto& current4 = cir.current(4);
+    EXPECT_EQ(cir.number_of_solved_circuits(), 1);
+    ASSERT_TRUE(current4.has_value());
+    EXPECT_TRUE(dbl_cmp(*current4, -1.0));
+
+    const std::size_t indexes[] = {3, 5, 6};
+    const auto& currents = cir.currents(indexes);
+    EXPECT_EQ(cir.number_of_solved_circuits(), 2);
+    ASSERT_EQ(currents.size(), 3);
+    EXPECT_TRUE(dbl_cmp(*currents[0], 1.0));
+    EXPECT_TRUE(dbl_cmp(*currents[1], 1.0));
+    EXPECT_TRUE(dbl_cmp(*currents[2], 1.0));
+
+    const auto& solution = cir.solve_circuit();
+    EXPECT_EQ(cir.number_of_solved_circuits(), 3);
+    EXPECT_TRUE(dbl_cmp(solution[0].second, 1.0));
+    EXPECT_TRUE(dbl_cmp(solution[7].second, -1.0));
+
+    EXPECT_THROW(cir.current(8), std::out_of_range);
+}
+
+TEST(Circuit, concurrentQueries)
+{
+    const auto& edges = Circuit::Generators::many_components(20, 30);
+    const Circuit::Circuit reference (edges.cbegin(), edges.cend());
+    const auto& expected = reference.solve_circuit();
+
+    const Circuit::Circuit cir (edges.cbegin(), edges.cend());
+    Container::Vector<Circuit::Circuit::Solution> solutions (4);
+    Container::Vector<std::thread> threads {};
+    for (std::size_t i = 0; i < solutions.size(); ++i)
+        threads.push_back(std::thread{[&, i]
+        {
+            for (std::size_t edge = i; edge < cir.number_of_edges(); edge += solutions.size())
+                cir.current(edge);
+            solutions[i] = cir.solve_circuit();
+        }});
+    for (auto& thread: threads)
+        thread.join();
+
+    EXPECT_EQ(cir.number_of_solved_circuits(), cir.number_of_connected_circuits());
+    for (const auto& solution: solutions)
+    {
+        ASSERT_EQ(solution.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+            EXPECT_EQ(solution[i].second, expected[i].second);
+    }
+}
+
+TEST(Circuit, memoPerOptions)
+{
+    const Circuit::Circuit cir {
+        {1, 2, 1.0},
+        {1, 3, 1.0},
+        {2, 3, 1.0, 3.0}
+    };
+    std::ostringstream log {};
+    Circuit::SolverOptions dense {Circuit::Solver::dense};
+    Circuit::SolverOptions envelope {Circuit::Solver::envelope};
+    dense.log_ = envelope.log_ = &log;
+
+    auto number_of_solves = [&log]
+    {
+        const auto& str = log.str();
+        return std::count(str.cbegin(), str.cend(), '\n');
+    };
+    // alternating options are solved once each
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(dbl_cmp(*cir.current(2, dense), 1.0));
+        EXPECT_TRUE(dbl_cmp(*cir.current(2, envelope), 1.0));
+    }
+    EXPECT_EQ(number_of_solves(), 2);
+}
+
+TEST(Circuit, addRemoveEdges)
+{
+    Circuit::Circuit cir {
+        {1, 2, 1.0},
+        {1, 3, 1.0},
+        {4, 5, 1.0},
+        {4, 6, 1.0},
+        {5, 6, 1.0, 3.0}
+    };
+    EXPECT_EQ(cir.number_of_connected_circuits(), 2);
+    cir.solve_circuit();
+    EXPECT_EQ(cir.number_of_solved_circuits(), 2);
+
+    const auto place1 = cir.edge_place(1);
+    const auto closing_edge = cir.add_edge({2, 3, 1.0, 3.0});
+    EXPECT_EQ(closing_edge, 5);
+    EXPECT_EQ(cir.number_of_connected_circuits(), 2);
+    EXPECT_EQ(cir.number_of_solved_circuits(), 1);
+    // new edge is appended to its connected circuit
+    EXPECT_EQ(cir.edge_place(1), place1);
+    EXPECT_EQ(cir.edge_place(closing_edge), std::make_pair(place1.first, std::size_t{2}));
+    EXPECT_TRUE(dbl_cmp(*cir.current(closing_edge), 1.0));
+    EXPECT_TRUE(dbl_cmp(*cir.current(1), -1.0));
+
+    const auto bridge = cir.add_edge({3, 4, 1.0});
+    EXPECT_EQ(cir.number_of_connected_circuits(), 1);
+    EXPECT_EQ(cir.number_of_nodes(), 6);
+    EXPECT_EQ(cir.number_of_edges(), 7);
+    EXPECT_TRUE(dbl_cmp(*cir.current(bridge), 0.0));
+    EXPECT_TRUE(dbl_cmp(*cir.current(4), 1.0));
+
+    cir.remove_edge(bridge);
+    EXPECT_EQ(cir.number_of_connected_circuits(), 2);
+    EXPECT_EQ(cir.number_of_edges(), 6);
+    EXPECT_THROW(cir.current(bridge), std::out_of_range);
+    EXPECT_THROW(cir.remove_edge(bridge), std::out_of_range);
+
+    cir.remove_edge(0);
+    EXPECT_EQ(cir.number_of_connected_circuits(), 2);
+    EXPECT_EQ(cir.number_of_nodes(), 6);
+    EXPECT_TRUE(dbl_cmp(*cir.current(closing_edge), 0.0));
+
+    cir.change_edge(4, 1.0, 6.0);
+    const auto& solution = cir.solve_circuit();
+    EXPECT_EQ(solution.size(), 7); // indexed by edge indexes
+    EXPECT_FALSE(cir.has_edge(0));
+    EXPECT_FALSE(cir.has_edge(bridge));
+    EXPECT_EQ(solution[0].first.node1_, 0);
+    EXPECT_EQ(solution[bridge].first.node1_, 0);
+    EXPECT_EQ(solution[4].first.node1_, 5);
+    EXPECT_TRUE(dbl_cmp(solution[4].second, 2.0)); // 5 -- 6
+    EXPECT_TRUE(dbl_cmp(solution[closing_edge].second, 0.0)); // 2 -- 3
+    EXPECT_TRUE(dbl_cmp(solution[4].second, *cir.current(4)));
+    EXPECT_LT(cir.verify(solution).max(), 1e-9);
+
+    cir.remove_edge(1);
+    cir.remove_edge(closing_edge);
+    EXPECT_EQ(cir.number_of_connected_circuits(), 1);
+    EXPECT_EQ(cir.number_of_nodes(), 3);
+}
+
+TEST(ConnectedCircuit, find_zero_resistance_loop)
+{
+    Circuit::ConnectedCircuit cir1 {
+        {1, 2, 0.0, 5.0},
+        {2, 3, 1.0},
+        {1, 3, 0.0},
+        {3, 4, 0.0, 3.0},
+        {4, 2, 0.0}
+    };
+    const auto& loop1 = cir1.find_zero_resistance_loop();
+    ASSERT_EQ(loop1.size(), 4);
+    std::set<unsigned> loop1_indexes {};
+    for (const auto& edge: loop1)
+        loop1_indexes.insert(edge.ind_);
+    EXPECT_EQ(loop1_indexes, (std::set<unsigned>{0, 2, 3, 4}));
+    EXPECT_TRUE(cir1.solve_circuit().empty());
+
+    Circuit::ConnectedCircuit cir2 {
+        {1, 2, 0.0, 10.0},
+        {1, 2, 1.0},
+        {1, 3, 3.0},
+        {2, 3, 0.0, 20.0}
+    };
+    EXPECT_TRUE(cir2.find_zero_resistance_loop().empty());
+    EXPECT_EQ(cir2.solve_circuit().size(), 4);
+
+    Circuit::ConnectedCircuit cir3 {
+        {1, 2, 1.0},
+        {2, 2, 0.0, 1.0}
+    };
+    const auto& loop3 = cir3.find_zero_resistance_loop();
+    ASSERT_EQ(loop3.size(), 1);
+    EXPECT_EQ(loop3[0].ind_, 1);
+
+    Circuit::Circuit cir4 {
+        {1, 2, 0.0, 1.0},
+        {1, 2, 0.0, 2.0},
+        {3, 4, 1.0}
+    };
+    const auto& loops4 = cir4.zero_resistance_loops();
+    ASSERT_EQ(loops4.size(), 1);
+    EXPECT_EQ(loops4[0].size(), 2);
+    EXPECT_FALSE(cir4.current(0).has_value());
+    EXPECT_TRUE(cir4.current(2).has_value());
+}
+
+TEST(Residuals, compute_residuals)
+{
+    const Container::Vector<Circuit::InputOutput::InputEdge> edges {
+        {1, 2, 1.0},
+        {1, 3, 1.0},
+        {2, 3, 1.0, 3.0},
+        {7, 8, 1.0, 2.0}
+    };
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+
+    const auto& exact = Circuit::compute_residuals(edges, Container::Vector<double>{1.0, -1.0, 1.0, nan});
+    EXPECT_LT(exact.max(), 1e-12);
+    EXPECT_EQ(exact.number_of_checked_nodes_, 3);
+    EXPECT_EQ(exact.number_of_checked_edges_, 3);
+    EXPECT_EQ(exact.number_of_unsolved_edges_, 1);
+
+    const auto& wrong = Circuit::compute_residuals(edges, Container::Vector<double>{1.0, -1.0, 1.5, nan});
+    EXPECT_TRUE(dbl_cmp(wrong.max_kcl_, 0.5 / 3.0)); // scale of currents is emf / resistance of edge 2 -- 3
+    EXPECT_EQ(wrong.worst_node_, 2);
+    EXPECT_GT(wrong.max_kvl_, 0.1);
+
+    // nearly zero currents of circuit without loops with emf are rounding errors, not violated laws
+    const Container::Vector<Circuit::InputOutput::InputEdge> tree {{1, 2, 1.0, 5.0}, {2, 3, 1.0}};
+    EXPECT_LT(Circuit::compute_residuals(tree, Container::Vector<double>{1e-17, -1e-17}).max(), 1e-12);
+}
+
+TEST(Stats, report)
+{
+    const Circuit::Circuit cir {
+        {1, 2, 1.0},
+        {1, 3, 1.0},
+        {2, 3, 1.0, 3.0},
+        {7, 8, 1.0, 2.0},
+        {7, 8, 1.0},
+        {10, 11, 0.0, 1.0}, // loop of ideal sources isn't solved
+        {10, 11, 0.0, 2.0}
+    };
+
+    Circuit::Stats::enable();
+    const Circuit::Circuit copy = cir;
+    copy.solve_circuit();
+    Circuit::Stats::disable();
+    cir.solve_circuit();
+
+    const auto& report = Circuit::Stats::report();
+    EXPECT_EQ(report.solvers_[static_cast<std::size_t>(Circuit::Solver::dense)], 2);
+    EXPECT_EQ(report.solvers_[static_cast<std::size_t>(Circuit::Solver::automatic)], 1); // unsolved
+    EXPECT_EQ(report.phases_[static_cast<std::size_t>(Circuit::Stats::Phase::assembly)].calls_, 2);
+    EXPECT_EQ(report.phases_[static_cast<std::size_t>(Circuit::Stats::Phase::elimination)].calls_, 2);
+    EXPECT_EQ(report.phases_[static_cast<std::size_t>(Circuit::Stats::Phase::split)].calls_, 0);
+    ASSERT_EQ(report.slowest_components_.size(), 3);
+    EXPECT_GE(report.slowest_components_[0].seconds_, report.slowest_components_[1].seconds_);
+    ASSERT_EQ(report.nodes_histogram_.size(), 2);
+    EXPECT_EQ(report.nodes_histogram_[1], 3); // 2, 2 and 3 nodes
+    EXPECT_GT(report.peak_rss_kb_, 0);
+
+    // phase which touches more memory than process ever had grows its peak RSS at least by difference
+    const auto peak = Circuit::Stats::peak_rss_kb();
+    Circuit::Stats::enable();
+    {
+        Circuit::Stats::Timer parse {Circuit::Stats::Phase::parse};
+        std::vector<char> memory ((peak + 16 * 1024) * 1024, 1);
+        EXPECT_EQ(memory.back(), 1);
+    }
+    Circuit::Stats::disable();
+    EXPECT_GE(Circuit::Stats::report().phases_[static_cast<std::size_t>(Circuit::Stats::Phase::parse)].peak_rss_growth_kb_,
+              15 * 1024);
+
+    std::ostringstream os {};
+    Circuit::Stats::write_json(os, report);
+    EXPECT_NE(os.str().find("\"dense\": 2"), std::string::npos);
+    EXPECT_NE(os.str().find("\"unsolved\": 1"), std::string::npos);
+}
+
+TEST(ConnectedCircuit, solve_circuitSolvers)
+{
+    const std::initializer_list<Circuit::InputOutput::InputEdge> edges1 {
+        {1, 2, 4.0},
+        {1, 3, 10.0},
+        {1, 4, 2.0, -12.0},
+        {2, 3, 60.0},
+        {2, 4, 22.0},
+        {3, 4, 5.0}
+    };
+    const std::initializer_list<Circuit::InputOutput::InputEdge> edges2 {
+        {1, 2, 0.0, 10.0},
+        {1, 2, 1.0},
+        {1, 3, 3.0},
+        {2, 3, 10.0, 20.0},
+        {2, 3, 2.0},
+        {3, 4, 0.0, 5.0},
+        {4, 5, 0.0},
+        {5, 3, 2.0, 1.0},
+        {6, 6, 1.0, 1.0},
+        {5, 6, 1.0}
+    };
+    Container::Vector<Circuit::InputOutput::InputEdge> edges3 {};
+    const unsigned side = 6;
+    for (unsigned i = 0; i < side; ++i)
+        for (unsigned j = 0; j < side; ++j)
+        {
+            const auto node = i * side + j;
+            if (j + 1 < side)
+                edges3.push_back({node, node + 1, 1.0 + (i + j) % 3, (i == j) ? 2.0 : 0.0});
+            if (i + 1 < side)
+                edges3.push_back({node, node + side, 2.0, (j == 0) ? -1.0 : 0.0});
+        }
+
+    const Circuit::ConnectedCircuit cirs[] = {
+        Circuit::ConnectedCircuit(edges1),
+        Circuit::ConnectedCircuit(edges2),
+        Circuit::ConnectedCircuit(edges3.cbegin(), edges3.cend())
+    };
+    for (const auto& cir: cirs)
+    {
+        const auto& dense = cir.solve_circuit({Circuit::Solver::dense});
+        ASSERT_EQ(dense.size(), cir.number_of_edges());
+        for (auto solver: {Circuit::Solver::envelope, Circuit::Solver::conjugate_gradient,
+                           Circuit::Solver::schur, Circuit::Solver::automatic})
+        {
+            Circuit::SolverOptions options {solver};
+            options.number_of_threads_ = 3;
+            const auto& solution = cir.solve_circuit(options);
+            ASSERT_EQ(solution.size(), dense.size());
+            for (std::size_t i = 0; i < solution.size(); ++i)
+                EXPECT_TRUE(dbl_cmp(solution[i].second, dense[i].second)) << Circuit::solver_name(solver) << " " << i;
+        }
+    }
+
+    const auto& cir3 = cirs[2];
+    std::ostringstream log {};
+    Circuit::SolverOptions options {};
+    options.log_ = &log;
+    options.memory_budget_ = cir3.estimate_cost(Circuit::Solver::dense).memory_ - 1;
+    const auto& solution3 = cir3.solve_circuit(options);
+    EXPECT_EQ(solution3.size(), cir3.number_of_edges());
+    EXPECT_EQ(log.str().find("dense"), std::string::npos);
+    EXPECT_NE(log.str().find("solver"), std::string::npos);
+
+    options.memory_budget_ = 0;
+    EXPECT_EQ(cir3.solve_circuit(options).size(), cir3.number_of_edges());
+    EXPECT_NE(log.str().find("there is no solver fitting in memory budget"), std::string::npos);
+
+    // only dense solver may solve circuit with negative resistances, budget doesn't stop it
+    Container::Vector<Circuit::InputOutput::InputEdge> negative_grid (edges3.cbegin(), edges3.cend());
+    negative_grid.front().resistance_ = -0.5;
+    const Circuit::ConnectedCircuit negative_cir (negative_grid.cbegin(), negative_grid.cend());
+    options.log_ = nullptr;
+    EXPECT_EQ(negative_cir.solve_circuit(options).size(), negative_cir.number_of_edges());
+
+    const Circuit::ConnectedCircuit negative {{1, 2, -1.0, 1.0}, {1, 2, 2.0}};
+    EXPECT_THROW(negative.solve_circuit({Circuit::Solver::envelope}), std::invalid_argument);
+    EXPECT_EQ(negative.solve_circuit({Circuit::Solver::dense}).size(), 2);
+}
+
+TEST(ConnectedCircuit, solve_circuitSchur)
+{
+    // grid is dissected in several levels of subdomains and separators, wires merge nodes in supernodes
+    auto edges = Circuit::Generators::grid(16, 16);
+    edges[5].resistance_ = edges[100].resistance_ = 0.0;
+    const Circuit::ConnectedCircuit cir (edges.cbegin(), edges.cend());
+    const Circuit::NodalSLAE nodal (cir.edges());
+    EXPECT_LT(nodal.dissection_flops(4), nodal.dissection_flops(1) / 2);
+
+    const auto& dense = cir.solve_circuit({Circuit::Solver::dense});
+    ASSERT_EQ(dense.size(), cir.number_of_edges());
+    for (std::size_t threads: {1, 3, 4, 8})
+    {
+        Circuit::SolverOptions options {Circuit::Solver::schur};
+        options.number_of_threads_ = threads;
+        const auto& schur = cir.solve_circuit(options);
+        ASSERT_EQ(schur.size(), dense.size());
+        for (std::size_t i = 0; i < schur.size(); ++i)
+            EXPECT_TRUE(dbl_cmp(schur[i].second, dense[i].second)) << threads << " threads, edge " << i;
+    }
+
+    // nested dissection factor of big grid is much smaller than its envelope
+    const auto& big_edges = Circuit::Generators::grid(100, 100);
+    const Circuit::ConnectedCircuit big (big_edges.cbegin(), big_edges.cend());
+    const Circuit::NodalSLAE big_nodal (big.edges());
+    Circuit::SolverOptions options {};
+    options.number_of_threads_ = 4;
+    EXPECT_EQ(big.choose_solvers(options, &big_nodal).front().solver_, Circuit::Solver::schur);
+}
+
+TEST(Circuit, verify)
+{
+    Container::Vector<Circuit::InputOutput::InputEdge> edges {};
+    const unsigned side = 8;
+    for (unsigned i = 0; i < side; ++i)
+        for (unsigned j = 0; j < side; ++j)
+        {
+            const auto node = i * side + j;
+            if (j + 1 < side)
+                edges.push_back({node, node + 1, 1.0 + (i * j) % 7, (i == j) ? 2.0 : 0.0});
+            if (i + 1 < side)
+                edges.push_back({node, node + side, 100.0, (j == 0) ? -1.0 : 0.0});
+        }
+    edges.push_back({100, 101, 0.0, 1.0}); // unsolvable loop of ideal sources
+    edges.push_back({100, 101, 0.0, 2.0});
+
+    // conjugate gradient stopped too early fails verification, circuit is solved again by direct solver
+    std::ostringstream log {};
+    Circuit::SolverOptions options {Circuit::Solver::conjugate_gradient};
+    options.tolerance_ = 1e-1;
+    options.verification_tolerance_ = 1e-9;
+    options.log_ = &log;
+    const Circuit::Circuit cir (edges.cbegin(), edges.cend());
+    const auto& solution = cir.solve_circuit(options);
+    EXPECT_NE(log.str().find("conjugate_gradient solver failed verification"), std::string::npos);
+
+    const auto& residuals = cir.verify(solution);
+    EXPECT_LT(residuals.max(), 1e-9);
+    EXPECT_EQ(residuals.number_of_unsolved_edges_, 2);
+    EXPECT_EQ(residuals.number_of_checked_nodes_, side * side);
+    // edges of unsolved connected circuit keep their nodes
+    EXPECT_EQ(solution.back().first.node1_, 100);
+    EXPECT_TRUE(std::isnan(solution.back().second));
+
+    // without verification solution of conjugate gradient is accepted, memoized solution is forgotten for new options
+    options.verification_tolerance_ = 0.0;
+    EXPECT_GT(cir.verify(cir.solve_circuit(options)).max(), 1e-9);
+    EXPECT_LT(cir.verify(cir.solve_circuit()).max(), 1e-9);
+
+    auto wrong = solution;
+    wrong[3].second += 1.0;
+    EXPECT_GT(cir.verify(wrong).max_kcl_, 1e-3);
+    wrong[3] = Circuit::Circuit::EdgeCur{};
+    EXPECT_THROW(cir.verify(wrong), std::invalid_argument);
+    wrong.pop_back();
+    EXPECT_THROW(cir.verify(wrong), std::invalid_argument);
+
+    // overflowed currents don't pass verification
+    const Circuit::ConnectedCircuit overflow {
+        {1, 2, 0.1, 1.5e308},
+        {2, 1, 0.1}
+    };
+    const auto& overflowed = overflow.solve_currents(overflow.make_plan());
+    ASSERT_EQ(overflowed.size(), 2);
+    EXPECT_FALSE(std::isfinite(overflowed[0]));
+    EXPECT_TRUE(std::isnan(overflow.verify(overflowed).max()));
+    Circuit::SolverOptions verified {};
+    verified.verification_tolerance_ = 1e-9;
+    EXPECT_TRUE(overflow.solve_currents(overflow.make_plan(verified), verified).empty());
+}
+
+TEST(CircuitPattern, solve)
+{
+    Container::Vector<Circuit::InputOutput::InputEdge> edges {};
+    const unsigned side = 8;
+    for (unsigned i = 0; i < side; ++i)
+        for (unsigned j = 0; j < side; ++j)
+        {
+            const auto node = i * side + j;
+            if (j + 1 < side)
+                edges.push_back({node, node + 1, 1.0 + (i * j) % 7, (i == j) ? 2.0 : 0.0});
+            if (i + 1 < side)
+                edges.push_back({node, node + side, (i == 3) ? 0.0 : 10.0, (j == 0) ? -1.0 : 0.0});
+        }
+    edges.push_back({100, 101, 2.0, 3.0}); // small connected circuit solved by dense solver
+    edges.push_back({101, 102, 4.0, 0.0});
+    edges.push_back({102, 100, 1.0, 0.0});
+    edges.push_back({200, 201, 0.0, 1.0}); // unsolvable loop of ideal sources
+    edges.push_back({200, 201, 0.0, 2.0});
+
+    const Circuit::CircuitPattern pattern (edges.cbegin(), edges.cend());
+    EXPECT_EQ(pattern.number_of_edges(), edges.size());
+    EXPECT_EQ(pattern.number_of_connected_circuits(), 3);
+
+    Container::Vector<Circuit::CircuitPattern::ValueSet> value_sets {};
+    for (unsigned sample = 0; sample < 4; ++sample)
+    {
+        auto values = pattern.values();
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            values[i].resistance_ *= 1.0 + 0.05 * ((i + sample) % 5);
+            values[i].emf_ += 0.1 * sample;
+        }
+        value_sets.push_back(values);
+    }
+
+    const auto& batch = pattern.solve_batch(value_sets);
+    ASSERT_EQ(batch.size(), value_sets.size());
+    for (std::size_t sample = 0; sample < value_sets.size(); ++sample)
+    {
+        auto perturbed = edges;
+        for (std::size_t i = 0; i < edges.size(); ++i)
+        {
+            perturbed[i].resistance_ = value_sets[sample][i].resistance_;
+            perturbed[i].emf_        = value_sets[sample][i].emf_;
+        }
+        const auto& solution = Circuit::Circuit(perturbed.cbegin(), perturbed.cend()).solve_circuit();
+        const auto& currents = pattern.solve(value_sets[sample]);
+        ASSERT_EQ(currents.size(), edges.size());
+        for (std::size_t i = 0; i + 2 < edges.size(); ++i)
+        {
+            EXPECT_TRUE(dbl_cmp(currents[i], solution[i].second));
+            EXPECT_EQ(currents[i], batch[sample][i]);
+        }
+        EXPECT_TRUE(std::isnan(currents[edges.size() - 1]));
+        EXPECT_TRUE(std::isnan(currents[edges.size() - 2]));
+    }
+
+    // batch threads share budget of threads with schur solver
+    Circuit::SolverOptions schur_options {Circuit::Solver::schur};
+    schur_options.number_of_threads_ = 4;
+    const Circuit::CircuitPattern schur_pattern (edges.cbegin(), edges.cend(), schur_options);
+    const auto& schur_batch = schur_pattern.solve_batch(value_sets);
+    for (std::size_t sample = 0; sample < value_sets.size(); ++sample)
+        for (std::size_t i = 0; i + 2 < edges.size(); ++i)
+            EXPECT_TRUE(dbl_cmp(schur_batch[sample][i], batch[sample][i]));
+
+    auto wrong = pattern.values();
+    wrong[0].resistance_ = 0.0;
+    EXPECT_THROW(pattern.solve(wrong), std::invalid_argument);
+    wrong.pop_back();
+    EXPECT_THROW(pattern.solve_batch({wrong}), std::invalid_argument);
+}
+
+TEST(Generators, smallSizes)
+{
+    namespace Gen = Circuit::Generators;
+    EXPECT_TRUE(Gen::giant_component(0).empty());
+    EXPECT_TRUE(Gen::giant_component(1).empty());
+    EXPECT_EQ(Gen::giant_component(2).size(), 4); // tree edge and extra ones up to average degree
+    EXPECT_TRUE(Gen::random_sparse(0).empty());
+    EXPECT_TRUE(Gen::random_sparse(1).empty());
+    EXPECT_EQ(Gen::random_sparse(2).size(), 3);
+    EXPECT_TRUE(Gen::many_components(16, 1).empty());
+    EXPECT_TRUE(Gen::many_components(16, 0).empty());
+
+    const auto& edges = Gen::many_components(4, 8);
+    EXPECT_EQ(edges.size(), 4 * 12);
+    EXPECT_EQ(Circuit::Circuit(edges.cbegin(), edges.cend()).number_of_connected_circuits(), 4);
+}
+
+TEST(BoundedQueue, close)
+{
+    Circuit::BoundedQueue<int> queue {1};
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_FALSE(queue.try_push(2));
+
+    // push waiting for room gives up when queue is closed
+    auto pushed = std::async(std::launch::async, [&]{return queue.push(3);});
+    EXPECT_EQ(pushed.wait_for(std::chrono::milliseconds{50}), std::future_status::timeout);
+    queue.close();
+    EXPECT_FALSE(pushed.get());
+
+    EXPECT_FALSE(queue.push(4));
+    EXPECT_FALSE(queue.try_push(5));
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+// Solution of one circuit as currents writes it
+std::string solve_text(const std::string& text)
+{
+    std::istringstream is {text};
+    const auto& edges = Circuit::InputOutput::input(is);
+    const auto& solution = Circuit::Circuit(edges.cbegin(), edges.cend()).solve_circuit();
+    std::ostringstream os {};
+    Circuit::InputOutput::output(solution.cbegin(), solution.cend(), os);
+    return os.str();
+}
+
+TEST(Batch, runStream)
+{
+    const std::string first  = "1 -- 2, 1; 1V\n2 -- 1, 1;\n";
+    const std::string second = "1 -- 2, oops\n";
+    const std::string third  = "1 -- 2, 2; 2V\n2 -- 3, 2;\n3 -- 1, 4;\n";
+
+    // several empty lines (with spaces too) split circuits, empty lines at the ends are skipped
+    std::istringstream is {"\n" + first + "\n  \n\n" + second + "\n" + third + "\n\n"};
+    std::ostringstream os {}, err {};
+    EXPECT_EQ(Circuit::Batch::run(is, os, {}, err), 1);
+    // failed circuit leaves empty solution, the rest come out in input order
+    EXPECT_EQ(os.str(), solve_text(first) + "\n\n" + solve_text(third));
+    const auto& errors = err.str();
+    EXPECT_EQ(errors.rfind("circuit 2: ", 0), 0);
+    EXPECT_EQ(std::count(errors.cbegin(), errors.cend(), '\n'), 1);
+
+    std::istringstream empty {"\n \n"};
+    std::ostringstream empty_os {}, empty_err {};
+    EXPECT_EQ(Circuit::Batch::run(empty, empty_os, {}, empty_err), 0);
+    EXPECT_TRUE(empty_os.str().empty());
+    EXPECT_TRUE(empty_err.str().empty());
+
+    // circuits of different sizes are solved in several threads and still come out in input order
+    std::string texts {}, expected {};
+    for (unsigned i = 0; i < 40; ++i)
+    {
+        const auto size = (i % 5 == 0) ? 400 : 3 + i;
+        std::string text {};
+        for (unsigned node = 1; node < size; ++node)
+            text += std::to_string(node) + " -- " + std::to_string(node + 1) + ", " + std::to_string(node % 3 + 1) + "; 1V\n";
+        text += std::to_string(size) + " -- 1, " + std::to_string(i + 1) + ";\n";
+        texts += text + '\n';
+        if (i != 0)
+            expected += '\n';
+        expected += solve_text(text);
+    }
+    std::istringstream many {texts};
+    std::ostringstream many_os {}, many_err {}, log {};
+    Circuit::SolverOptions options {};
+    options.number_of_threads_ = 4;
+    options.log_ = &log;
+    EXPECT_EQ(Circuit::Batch::run(many, many_os, options, many_err), 0);
+    EXPECT_EQ(many_os.str(), expected);
+    EXPECT_TRUE(many_err.str().empty());
+}
+
+TEST(Batch, runDirectory)
+{
+    const auto directory = std::filesystem::temp_directory_path() / ("circuit_batch_" + std::to_string(::getpid()));
+    std::filesystem::create_directories(directory / "c_directory");
+    const std::string first = "1 -- 2, 1; 1V\n2 -- 1, 1;\n";
+    const std::string third = "1 -- 2, 2; 2V\n2 -- 3, 2;\n3 -- 1, 4;\n";
+    // files are taken in order of their names, directories are skipped
+    std::ofstream{directory / "d.txt"} << third;
+    std::ofstream{directory / "b.txt"} << "1 -- 2, oops\n";
+    std::ofstream{directory / "a.txt"} << first;
+
+    std::ostringstream os {}, err {};
+    EXPECT_EQ(Circuit::Batch::run(directory, os, {}, err), 1);
+    EXPECT_EQ(os.str(), solve_text(first) + "\n\n" + solve_text(third));
+    EXPECT_EQ(err.str().rfind("circuit 2: ", 0), 0);
+
+    std::filesystem::remove_all(directory);
+    EXPECT_THROW(Circuit::Batch::run(directory, os, {}, err), std::filesystem::filesystem_error);
+}
+
+// Connects as soon as server listens
+std::unique_ptr<Circuit::Server::Client> connect_to_server(const std::filesystem::path& path)
+{
+    for (int attempt = 0;; ++attempt)
+        try {
+            return std::make_unique<Circuit::Server::Client>(path);
+        } catch(std::runtime_error&) {
+            if (attempt == 500)
+                throw;
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+}
+
+TEST(Server, run)
+{
+    namespace Server = Circuit::Server;
+    const auto path = std::filesystem::temp_directory_path() / ("circuit_test_" + std::to_string(::getpid()) + ".sock");
+    Server::ServerOptions options {};
+    options.number_of_workers_ = 2;
+    options.max_request_size_  = 1 << 16;
+    auto server = std::async(std::launch::async, [&]{Server::run(path, options);});
+
+    // idle connections don't hold workers
+    const auto idle1 = connect_to_server(path);
+    const auto idle2 = connect_to_server(path);
+    auto client = connect_to_server(path);
+
+    const Server::Frame text_request {Server::Kind::text, "1 -- 2, 1; 1V\n2 -- 1, 1;\n"};
+    const auto& text = client->solve(text_request);
+    EXPECT_EQ(text.kind_, Server::Kind::ok);
+    EXPECT_NE(text.payload_.find("0.5 A"), std::string::npos);
+    const Container::Vector<Circuit::InputOutput::InputEdge> edges {{1, 2, 1.0, 1.0}, {2, 1, 1.0}};
+    const auto& binary = client->solve({Server::Kind::binary, Server::encode_binary(edges)});
+    EXPECT_EQ(binary.kind_, Server::Kind::ok);
+    EXPECT_EQ(binary.payload_, text.payload_);
+
+    // errors are answered and connection goes on
+    EXPECT_EQ(client->solve({Server::Kind::text, "1 -- 2, oops\n"}).kind_, Server::Kind::error);
+    EXPECT_EQ(client->solve({Server::Kind::binary, "abc"}).kind_, Server::Kind::error);
+    EXPECT_EQ(client->solve({static_cast<Server::Kind>('X'), ""}).kind_, Server::Kind::error);
+    EXPECT_EQ(client->solve(text_request).payload_, text.payload_);
+
+    // identical requests sent at the same time are solved once
+    std::string grid {};
+    for (unsigned i = 1; i < 900; ++i)
+        grid += std::to_string(i) + " -- " + std::to_string(i + 1) + ", " + std::to_string(i % 7 + 1) + "; 1V\n";
+    grid += "900 -- 1, 3;\n";
+    Circuit::Stats::enable();
+    std::vector<std::future<Server::Frame>> responses {};
+    for (int i = 0; i < 4; ++i)
+        responses.push_back(std::async(std::launch::async, [&]{return connect_to_server(path)->solve({Server::Kind::text, grid});}));
+    const auto& first = responses[0].get();
+    EXPECT_EQ(first.kind_, Server::Kind::ok);
+    for (std::size_t i = 1; i < responses.size(); ++i)
+        EXPECT_EQ(responses[i].get().payload_, first.payload_);
+    EXPECT_EQ(Circuit::Stats::report().counters_[static_cast<std::size_t>(Circuit::Stats::Counter::connected_circuits)], 1);
+    Circuit::Stats::disable();
+
+    // too big request is answered with error, then connection is closed
+    EXPECT_EQ(client->solve({Server::Kind::text, std::string(options.max_request_size_ + 1, ' ')}).kind_,
+              Server::Kind::error);
+    EXPECT_THROW(client->solve(text_request), std::runtime_error);
+
+    // server stops though clients stay connected
+    Server::stop();
+    ASSERT_EQ(server.wait_for(std::chrono::seconds{5}), std::future_status::ready);
+    server.get();
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
 int main(int argc, char** argv)
 {
     testing::InitGoogleTest(&argc, argv);